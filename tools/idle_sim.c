@@ -0,0 +1,386 @@
+/*
+ * Copyright (c) 2006-2022, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Run the idle governor of RT_USING_IDLE_GOVERNOR on a Linux host against a
+ * simulated board, and report the residency of each low power state, the
+ * energy and the wakeup latency penalty. Two reference policies run on the
+ * same event sequence: "shallow" always takes the shallowest state, "oracle"
+ * knows the length of every idle period in advance.
+ *
+ * The board sleeps between a periodic timer (known to the governor through
+ * rt_timer_next_timeout_tick) and interrupts it can't foresee, either periodic
+ * with jitter or random, and runs for a fixed time after each wakeup. With -s
+ * the interrupts come in a burst at the beginning of every second, so the idle
+ * periods are shorter than the target residency of every state for a while.
+ * The periodic system tick wakes the board every tick for a short handler, so
+ * no idle period is longer than one tick. With -n the board stops the tick
+ * while it sleeps, then idlegov.c shall be built with RT_IDLE_GOVERNOR_TICKLESS.
+ *
+ * Two boards are simulated: "wfi" has a state that pays off at once, "stop"
+ * has none, even its shallowest state has to stay 200 us to save energy.
+ *
+ * Build with idlegov.c compiled for the host, RT_USING_IDLE_GOVERNOR,
+ * RT_TICK_PER_SECOND and RT_IDLE_GOVERNOR_TICKLESS shall be the same for both
+ * files:
+ *     gcc -O2 -DRT_USING_IDLE_GOVERNOR -I<rt-thread>/include -I<bsp> \
+ *         idle_sim.c idlegov.c -o idle_sim
+ * This file provides rt_tick_get, rt_timer_next_timeout_tick and the interrupt
+ * functions used by the governor.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#ifndef RT_TICK_PER_SECOND
+#define RT_TICK_PER_SECOND  1000
+#endif
+#define TICK_US             (1000000ULL / RT_TICK_PER_SECOND)
+
+/* same layout as struct rt_idle_state */
+struct idle_state
+{
+    const char *name;
+    uint32_t exit_latency;
+    uint32_t target_residency;
+    uint32_t (*enter)(struct idle_state *state, uint32_t timeout);
+    uint32_t usage;
+    uint32_t early;
+    uint64_t residency;
+};
+
+/* same layout as struct rt_idle_latency */
+struct idle_latency
+{
+    void *next, *prev;
+    uint32_t latency;
+};
+
+long rt_idle_state_register(struct idle_state *state);
+void rt_idle_latency_request(struct idle_latency *request, uint32_t latency);
+void rt_idle_governor_enter(void);
+
+/* power model of one state, mW */
+struct sim_state
+{
+    struct idle_state state;
+    double power;
+};
+
+static uint32_t sim_enter(struct idle_state *state, uint32_t timeout);
+
+#define STATE_MAX   4
+/* run power, mW */
+static double run_power = 20.0;
+#define SIM_STATE(_name, _latency, _residency, _power) \
+    { .state = { .name = _name, .exit_latency = _latency, .target_residency = _residency, \
+                 .enter = sim_enter, .usage = 0, .early = 0, .residency = 0 }, .power = _power }
+static struct sim_state board_wfi[] =
+{
+    SIM_STATE("wfi",     2,    0,     5.0),
+    SIM_STATE("sleep",   30,   200,   1.0),
+    SIM_STATE("stop",    300,  2000,  0.1),
+    SIM_STATE("standby", 3000, 20000, 0.01),
+};
+static struct sim_state board_stop[] =
+{
+    SIM_STATE("sleep",   30,   200,   1.0),
+    SIM_STATE("stop",    300,  2000,  0.1),
+    SIM_STATE("standby", 3000, 20000, 0.01),
+};
+static struct sim_state *states = board_wfi;
+static int state_nr = sizeof(board_wfi) / sizeof(board_wfi[0]);
+
+/* workload */
+static uint64_t timer_period = 20000;
+static int irq_random = 0;
+static uint64_t irq_period = 3000, irq_jitter = 100;
+static uint64_t work_time = 200;
+/* interrupts every burst_irq us during the first burst_len us of every second */
+static uint64_t burst_irq = 0, burst_len = 100000;
+static uint32_t latency_limit = 0xffffffff;
+static uint64_t duration = 10000000;
+/* the system tick wakes the board unless it is stopped during sleep */
+static int tickless = 0;
+static uint64_t tick_time = 5;
+
+/* simulation state */
+static uint64_t now, next_timer, next_irq, next_tick;
+static uint64_t rng = 88172645463325252ULL;
+
+/* result of one policy */
+struct sim_result
+{
+    uint64_t residency[STATE_MAX];
+    uint32_t usage[STATE_MAX];
+    uint32_t early[STATE_MAX];
+    double energy;              /* nJ */
+    uint64_t penalty;           /* sum of exit latency paid by interrupts, us */
+    uint32_t penalty_max;
+    uint32_t irqs;
+    uint32_t ticks;             /* wakeups by the system tick */
+    uint32_t violations;        /* interrupts delayed over latency_limit */
+    uint32_t spins;             /* idle periods without low power state */
+};
+static struct sim_result *result;
+
+static uint64_t sim_random(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return rng;
+}
+
+static uint64_t sim_irq_interval(void)
+{
+    if (burst_irq && now % 1000000 < burst_len)
+        return burst_irq;
+
+    if (irq_random)
+    {
+        /* exponential distribution, mean irq_period */
+        double u = (double)(sim_random() >> 11) / (double)(1ULL << 53);
+
+        return (uint64_t)(-(double)irq_period * log(1.0 - u)) + 1;
+    }
+
+    return irq_period - irq_jitter + sim_random() % (2 * irq_jitter + 1);
+}
+
+/* stubs used by idlegov.c */
+long rt_hw_interrupt_disable(void)
+{
+    return 0;
+}
+
+void rt_hw_interrupt_enable(long level)
+{
+    (void)level;
+}
+
+uint32_t rt_tick_get(void)
+{
+    return (uint32_t)(now / TICK_US);
+}
+
+uint32_t rt_timer_next_timeout_tick(void)
+{
+    return (uint32_t)((next_timer + TICK_US - 1) / TICK_US);
+}
+
+/* the next event waking the board */
+static uint64_t sim_next_event(void)
+{
+    uint64_t wake;
+
+    wake = next_timer < next_irq ? next_timer : next_irq;
+    if (!tickless && next_tick < wake)
+        wake = next_tick;
+
+    return wake;
+}
+
+/* sleep in a state until the next event */
+static uint32_t sim_enter(struct idle_state *state, uint32_t timeout)
+{
+    int index = (int)((struct sim_state *)state - states);
+    uint64_t wake;
+
+    wake = sim_next_event();
+    if (wake > now + timeout)
+        wake = now + timeout;
+
+    result->usage[index] ++;
+    result->residency[index] += wake - now;
+    if (wake - now < state->target_residency)
+        result->early[index] ++;
+    /* transitions cost the exit latency at run power */
+    result->energy += (double)(wake - now) * states[index].power + (double)state->exit_latency * run_power;
+
+    if (wake == next_irq)
+    {
+        result->penalty += state->exit_latency;
+        if (state->exit_latency > result->penalty_max)
+            result->penalty_max = state->exit_latency;
+        if (state->exit_latency > latency_limit)
+            result->violations ++;
+    }
+
+    timeout = (uint32_t)(wake - now);
+    now = wake + state->exit_latency;
+
+    return timeout;
+}
+
+enum policy { POLICY_GOVERNOR, POLICY_SHALLOW, POLICY_ORACLE };
+
+static void sim_run(enum policy policy, struct sim_result *res)
+{
+    uint64_t before, idle;
+    int index;
+
+    memset(res, 0, sizeof(*res));
+    result = res;
+    rng = 88172645463325252ULL;
+    now = 0;
+    next_timer = timer_period;
+    next_irq = sim_irq_interval();
+    next_tick = TICK_US;
+
+    while (now < duration)
+    {
+        /* handle the events due and run */
+        if (next_irq <= now || next_timer <= now)
+        {
+            if (next_irq <= now)
+            {
+                res->irqs ++;
+                next_irq = now + sim_irq_interval();
+            }
+            while (next_timer <= now)
+                next_timer += timer_period;
+            while (next_tick <= now)
+                next_tick += TICK_US;
+            now += work_time;
+            res->energy += (double)work_time * run_power;
+            continue;
+        }
+        /* a tick with no timer due only runs its handler */
+        if (next_tick <= now)
+        {
+            if (!tickless)
+            {
+                res->ticks ++;
+                now += tick_time;
+                res->energy += (double)tick_time * run_power;
+            }
+            while (next_tick <= now)
+                next_tick += TICK_US;
+            continue;
+        }
+
+        before = now;
+        idle = sim_next_event() - now;
+
+        switch (policy)
+        {
+        case POLICY_GOVERNOR:
+            rt_idle_governor_enter();
+            break;
+        case POLICY_SHALLOW:
+            sim_enter(&states[0].state, 0xffffffff);
+            break;
+        case POLICY_ORACLE:
+            for (index = state_nr - 1; index > 0; index --)
+            {
+                if (states[index].state.target_residency <= idle &&
+                    states[index].state.exit_latency <= latency_limit)
+                    break;
+            }
+            sim_enter(&states[index].state, 0xffffffff);
+            break;
+        }
+
+        /* no state chosen, spin until the event */
+        if (now == before)
+        {
+            res->spins ++;
+            res->energy += (double)idle * run_power;
+            now += idle;
+        }
+    }
+}
+
+static void sim_print(const char *name, struct sim_result *res)
+{
+    int index;
+
+    printf("%-8s energy %.3f mJ, avg power %.3f mW, irq %u, tick %u, latency penalty avg %.1f us max %u us, over limit %u, spin %u\n",
+           name, res->energy / 1e6, res->energy / (double)now, res->irqs, res->ticks,
+           res->irqs ? (double)res->penalty / res->irqs : 0.0, res->penalty_max, res->violations, res->spins);
+    for (index = 0; index < state_nr; index ++)
+    {
+        printf("    %-8s usage %-8u early %-8u residency %5.1f%%\n", states[index].state.name,
+               res->usage[index], res->early[index], 100.0 * (double)res->residency[index] / (double)now);
+    }
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [-b board] [-t timer_us] [-i irq_us] [-j jitter_us] [-r] [-s burst_us] [-w work_us]\n"
+            "          [-n] [-q limit_us] [-d seconds]\n"
+            "  -b  simulated board, wfi or stop (default wfi)\n"
+            "  -t  period of the timer known to the governor (default 20000)\n"
+            "  -i  interval of unforeseen interrupts (default 3000)\n"
+            "  -j  jitter of the interrupt interval (default 100)\n"
+            "  -r  random interrupts with mean interval -i instead of periodic ones\n"
+            "  -s  interval of interrupts in a 100 ms burst every second (default none)\n"
+            "  -w  run time after each wakeup (default 200)\n"
+            "  -n  the board stops the system tick while it sleeps (default it doesn't)\n"
+            "  -q  exit latency limit requested by a thread (default none)\n"
+            "  -d  simulated time (default 10)\n", prog);
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    static struct sim_result res_governor, res_shallow, res_oracle;
+    static struct idle_latency request;
+    int index, opt;
+
+    while ((opt = getopt(argc, argv, "b:t:i:j:rs:w:nq:d:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'b':
+            if (strcmp(optarg, "wfi") == 0)
+            {
+                states = board_wfi;
+                state_nr = sizeof(board_wfi) / sizeof(board_wfi[0]);
+            }
+            else if (strcmp(optarg, "stop") == 0)
+            {
+                states = board_stop;
+                state_nr = sizeof(board_stop) / sizeof(board_stop[0]);
+            }
+            else
+            {
+                usage(argv[0]);
+            }
+            break;
+        case 't': timer_period = strtoull(optarg, NULL, 0); break;
+        case 'i': irq_period = strtoull(optarg, NULL, 0); break;
+        case 'j': irq_jitter = strtoull(optarg, NULL, 0); break;
+        case 'r': irq_random = 1; break;
+        case 's': burst_irq = strtoull(optarg, NULL, 0); break;
+        case 'w': work_time = strtoull(optarg, NULL, 0); break;
+        case 'n': tickless = 1; break;
+        case 'q': latency_limit = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'd': duration = strtoull(optarg, NULL, 0) * 1000000; break;
+        default: usage(argv[0]);
+        }
+    }
+    if (timer_period == 0 || irq_period == 0 || irq_jitter >= irq_period)
+        usage(argv[0]);
+
+    for (index = 0; index < state_nr; index ++)
+        rt_idle_state_register(&states[index].state);
+    if (latency_limit != 0xffffffff)
+        rt_idle_latency_request(&request, latency_limit);
+
+    sim_run(POLICY_GOVERNOR, &res_governor);
+    sim_print("governor", &res_governor);
+    sim_run(POLICY_SHALLOW, &res_shallow);
+    sim_print("shallow", &res_shallow);
+    sim_run(POLICY_ORACLE, &res_oracle);
+    sim_print("oracle", &res_oracle);
+
+    return 0;
+}
@@ -0,0 +1,459 @@
+/*
+ * Copyright (c) 2006-2022, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Replay an allocation trace recorded by RT_USING_SMALL_MEM_TRACE on a Linux
+ * host, and report latency percentiles, peak footprint and fragmentation of
+ * the allocator under test.
+ *
+ * Input is either the text printed by "smem_trace <heap> dump" (lines holding
+ * "smem <timestamp> <op> <size> <handle> <result>", other log lines are
+ * skipped), or with -b the raw struct rt_smem_trace_record stream taken out by
+ * rt_smem_trace_read.
+ *
+ * Build with libc malloc only:
+ *     gcc -O2 smem_replay.c -o smem_replay
+ * Build with the small memory algorithm, mem.c compiled for the host:
+ *     gcc -O2 -DREPLAY_WITH_RT_SMEM smem_replay.c mem.o <rt-thread host stubs> -o smem_replay
+ * Any allocator exporting rt_smem_init/alloc/realloc/free/alloc_align can be
+ * linked in the same way.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define OP_ALLOC        1
+#define OP_REALLOC      2
+#define OP_FREE         3
+#define OP_ALLOC_ALIGN  4
+#define OP_NR           5
+
+/* same layout as struct rt_smem_trace_record */
+struct trace_record
+{
+    uint32_t timestamp;
+    uint32_t op_size;
+    uint32_t handle;
+    uint32_t result;
+};
+
+/* allocator under test, all blocks are taken from [region, region + size) */
+struct replay_allocator
+{
+    const char *name;
+    int (*init)(void *region, size_t size);
+    void *(*alloc)(size_t size);
+    void *(*alloc_align)(size_t size, size_t align);
+    void *(*realloc)(void *ptr, size_t size);
+    void (*free)(void *ptr);
+    int in_region;              /* blocks lie in the region, footprint can be measured */
+};
+
+static void *libc_alloc_align(size_t size, size_t align)
+{
+    void *ptr;
+
+    return posix_memalign(&ptr, align < sizeof(void *) ? sizeof(void *) : align, size) ? NULL : ptr;
+}
+
+static int libc_init(void *region, size_t size)
+{
+    (void)region;
+    (void)size;
+    return 0;
+}
+
+static const struct replay_allocator libc_allocator =
+{
+    "libc", libc_init, malloc, libc_alloc_align, realloc, free, 0
+};
+
+#ifdef REPLAY_WITH_RT_SMEM
+typedef struct rt_memory *rt_smem_t;
+
+rt_smem_t rt_smem_init(const char *name, void *begin_addr, unsigned long size);
+void *rt_smem_alloc(rt_smem_t m, unsigned long size);
+void *rt_smem_alloc_align(rt_smem_t m, unsigned long size, unsigned long align);
+void *rt_smem_realloc(rt_smem_t m, void *rmem, unsigned long newsize);
+void rt_smem_free(void *rmem);
+
+static rt_smem_t smem;
+
+static int smem_init(void *region, size_t size)
+{
+    smem = rt_smem_init("replay", region, size);
+    return smem ? 0 : -1;
+}
+
+static void *smem_alloc(size_t size)
+{
+    return rt_smem_alloc(smem, size);
+}
+
+static void *smem_alloc_align(size_t size, size_t align)
+{
+    return rt_smem_alloc_align(smem, size, align);
+}
+
+static void *smem_realloc(void *ptr, size_t size)
+{
+    return rt_smem_realloc(smem, ptr, size);
+}
+
+static const struct replay_allocator smem_allocator =
+{
+    "rt_smem", smem_init, smem_alloc, smem_alloc_align, smem_realloc, rt_smem_free, 1
+};
+#endif /* REPLAY_WITH_RT_SMEM */
+
+/* live block, found by the handle recorded on the target */
+struct live_block
+{
+    uint32_t handle;            /* 0 for an empty slot */
+    uint32_t size;
+    char *ptr;
+};
+
+static struct live_block *live;
+static size_t live_cap, live_nr;
+
+static size_t live_slot(uint32_t handle)
+{
+    size_t slot = (handle * 2654435761u) & (live_cap - 1);
+
+    while (live[slot].handle != 0 && live[slot].handle != handle)
+        slot = (slot + 1) & (live_cap - 1);
+
+    return slot;
+}
+
+static void live_grow(void)
+{
+    size_t index, old_cap = live_cap;
+    struct live_block *old = live;
+
+    live_cap = live_cap ? live_cap * 2 : 1024;
+    live = calloc(live_cap, sizeof(struct live_block));
+    for (index = 0; index < old_cap; index ++)
+    {
+        if (old[index].handle)
+            live[live_slot(old[index].handle)] = old[index];
+    }
+    free(old);
+}
+
+static void live_put(uint32_t handle, char *ptr, uint32_t size)
+{
+    size_t slot;
+
+    if ((live_nr + 1) * 2 > live_cap)
+        live_grow();
+    slot = live_slot(handle);
+    if (live[slot].handle == 0)
+        live_nr ++;
+    live[slot].handle = handle;
+    live[slot].ptr = ptr;
+    live[slot].size = size;
+}
+
+static struct live_block *live_get(uint32_t handle)
+{
+    size_t slot;
+
+    if (handle == 0 || live_cap == 0)
+        return NULL;
+    slot = live_slot(handle);
+
+    return live[slot].handle ? &live[slot] : NULL;
+}
+
+/* remove with backward shift, keeps the probe sequences intact */
+static void live_del(struct live_block *block)
+{
+    size_t hole = block - live, slot = hole, home;
+
+    live_nr --;
+    while (1)
+    {
+        slot = (slot + 1) & (live_cap - 1);
+        if (live[slot].handle == 0)
+            break;
+        home = (live[slot].handle * 2654435761u) & (live_cap - 1);
+        if (((slot - home) & (live_cap - 1)) >= ((slot - hole) & (live_cap - 1)))
+        {
+            live[hole] = live[slot];
+            hole = slot;
+        }
+    }
+    live[hole].handle = 0;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+static int cmp_block(const void *a, const void *b)
+{
+    const struct live_block *x = a, *y = b;
+
+    return x->ptr < y->ptr ? -1 : x->ptr > y->ptr;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static int read_trace(FILE *fp, int binary, struct trace_record **records, size_t *count)
+{
+    char line[256], op, *p;
+    size_t cap = 0;
+    unsigned int ts, size, handle, result;
+    struct trace_record record;
+    const char *ops = "?arfA";
+
+    *records = NULL;
+    *count = 0;
+    while (1)
+    {
+        if (binary)
+        {
+            if (fread(&record, sizeof(record), 1, fp) != 1)
+                break;
+        }
+        else
+        {
+            if (fgets(line, sizeof(line), fp) == NULL)
+                break;
+            p = strstr(line, "smem ");
+            if (p == NULL || sscanf(p, "smem %u %c %u %u %u", &ts, &op, &size, &handle, &result) != 5 ||
+                strchr(ops + 1, op) == NULL)
+                continue;
+            record.timestamp = ts;
+            record.op_size = ((uint32_t)(strchr(ops, op) - ops) << 24) | (size & 0x00ffffff);
+            record.handle = handle;
+            record.result = result;
+        }
+        if (*count == cap)
+        {
+            cap = cap ? cap * 2 : 4096;
+            *records = realloc(*records, cap * sizeof(struct trace_record));
+            if (*records == NULL)
+                return -1;
+        }
+        (*records)[(*count) ++] = record;
+    }
+
+    return 0;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s [-b] [-m heap_size] [-a libc|rt_smem] trace\n", prog);
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    FILE *fp;
+    int binary = 0, opt;
+    size_t heap_size = 1024 * 1024, count, index, op_count[OP_NR] = {0};
+    size_t live_bytes = 0, peak_live = 0, peak_footprint = 0;
+    size_t failures = 0, unmatched = 0, free_bytes, largest_gap, gap, nr;
+    uint64_t *latency[OP_NR], t0, t1;
+    const char *allocator_name = NULL;
+    const char *op_names[OP_NR] = {"", "alloc", "realloc", "free", "alloc_align"};
+    const struct replay_allocator *allocator = &libc_allocator;
+    struct trace_record *records, *r;
+    struct live_block *block, *blocks;
+    char *region, *ptr, *end;
+    uint32_t op, size;
+
+    while ((opt = getopt(argc, argv, "bm:a:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'b': binary = 1; break;
+        case 'm': heap_size = strtoul(optarg, NULL, 0); break;
+        case 'a': allocator_name = optarg; break;
+        default: usage(argv[0]);
+        }
+    }
+    if (optind >= argc)
+        usage(argv[0]);
+
+#ifdef REPLAY_WITH_RT_SMEM
+    allocator = &smem_allocator;
+#endif
+    if (allocator_name && strcmp(allocator_name, allocator->name) != 0)
+    {
+        if (strcmp(allocator_name, "libc") != 0)
+        {
+            fprintf(stderr, "allocator %s is not built in\n", allocator_name);
+            return 1;
+        }
+        allocator = &libc_allocator;
+    }
+
+    fp = fopen(argv[optind], binary ? "rb" : "r");
+    if (fp == NULL || read_trace(fp, binary, &records, &count) != 0)
+    {
+        perror(argv[optind]);
+        return 1;
+    }
+    fclose(fp);
+
+    /* the small memory algorithm keeps 32 bit pool pointers in the block header */
+    region = mmap(NULL, heap_size, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+    if (region == MAP_FAILED || allocator->init(region, heap_size) != 0)
+    {
+        fprintf(stderr, "can't create a heap of %zu bytes\n", heap_size);
+        return 1;
+    }
+    for (op = 0; op < OP_NR; op ++)
+        latency[op] = malloc((count + 1) * sizeof(uint64_t));
+
+    for (index = 0; index < count; index ++)
+    {
+        r = &records[index];
+        op = r->op_size >> 24;
+        size = r->op_size & 0x00ffffff;
+        ptr = NULL;
+
+        switch (op)
+        {
+        case OP_ALLOC:
+        case OP_ALLOC_ALIGN:
+            t0 = now_ns();
+            ptr = op == OP_ALLOC ? allocator->alloc(size) : allocator->alloc_align(size, r->handle);
+            t1 = now_ns();
+            if (ptr == NULL)
+            {
+                failures += r->result != 0;
+                break;
+            }
+            /* failed on the target, the application never saw this block */
+            if (r->result == 0)
+            {
+                allocator->free(ptr);
+                ptr = NULL;
+                break;
+            }
+            live_put(r->result, ptr, size);
+            live_bytes += size;
+            break;
+
+        case OP_REALLOC:
+            block = live_get(r->handle);
+            if (block == NULL)
+            {
+                unmatched ++;
+                continue;
+            }
+            t0 = now_ns();
+            ptr = allocator->realloc(block->ptr, size);
+            t1 = now_ns();
+            if (ptr == NULL)
+            {
+                failures += r->result != 0;
+                break;
+            }
+            /* failed on the target, the application still uses the old handle */
+            if (r->result == 0)
+            {
+                block->ptr = ptr;
+                break;
+            }
+            live_bytes = live_bytes - block->size + size;
+            live_del(block);
+            live_put(r->result, ptr, size);
+            break;
+
+        case OP_FREE:
+            block = live_get(r->handle);
+            if (block == NULL)
+            {
+                unmatched ++;
+                continue;
+            }
+            t0 = now_ns();
+            allocator->free(block->ptr);
+            t1 = now_ns();
+            live_bytes -= block->size;
+            live_del(block);
+            break;
+
+        default:
+            continue;
+        }
+
+        latency[op][op_count[op] ++] = t1 - t0;
+        if (live_bytes > peak_live)
+            peak_live = live_bytes;
+        if (allocator->in_region && ptr != NULL && (size_t)(ptr + size - region) > peak_footprint)
+            peak_footprint = ptr + size - region;
+    }
+
+    printf("allocator %s, %zu records, %zu failures, %zu unmatched handles\n",
+           allocator->name, count, failures, unmatched);
+    printf("%-12s %10s %8s %8s %8s %8s %8s (ns)\n", "op", "count", "p50", "p90", "p99", "p99.9", "max");
+    for (op = 1; op < OP_NR; op ++)
+    {
+        nr = op_count[op];
+        if (nr == 0)
+            continue;
+        qsort(latency[op], nr, sizeof(uint64_t), cmp_u64);
+        printf("%-12s %10zu %8llu %8llu %8llu %8llu %8llu\n", op_names[op], nr,
+               (unsigned long long)latency[op][nr / 2],
+               (unsigned long long)latency[op][nr * 9 / 10],
+               (unsigned long long)latency[op][nr * 99 / 100],
+               (unsigned long long)latency[op][nr * 999 / 1000],
+               (unsigned long long)latency[op][nr - 1]);
+    }
+    printf("peak live %zu bytes\n", peak_live);
+
+    if (!allocator->in_region)
+        return 0;
+
+    /* footprint is the highest address ever used, the rest of the region was never touched */
+    printf("peak footprint %zu bytes, overhead %.1f%%\n", peak_footprint,
+           peak_footprint ? 100.0 * (peak_footprint - peak_live) / peak_footprint : 0.0);
+
+    /* fragmentation of the live blocks at the end of the trace, inside the footprint */
+    blocks = malloc((live_nr + 1) * sizeof(struct live_block));
+    for (index = 0, nr = 0; index < live_cap; index ++)
+    {
+        if (live[index].handle)
+            blocks[nr ++] = live[index];
+    }
+    qsort(blocks, nr, sizeof(struct live_block), cmp_block);
+    end = region;
+    free_bytes = largest_gap = 0;
+    for (index = 0; index <= nr; index ++)
+    {
+        gap = (index < nr ? blocks[index].ptr : region + peak_footprint) - end;
+        free_bytes += gap;
+        if (gap > largest_gap)
+            largest_gap = gap;
+        if (index < nr)
+            end = blocks[index].ptr + blocks[index].size;
+    }
+    printf("at end: %zu live blocks, %zu free bytes in footprint, largest hole %zu, fragmentation %.1f%%\n",
+           nr, free_bytes, largest_gap, free_bytes ? 100.0 - 100.0 * largest_gap / free_bytes : 0.0);
+
+    return 0;
+}
@@ -22,6 +22,190 @@
 
 static volatile rt_tick_t rt_tick = 0;/* ʼϵͳ */
 
+#ifdef RT_USING_CLOCK_MONOTONIC
+/*
+ * 뵥ʱ
+ *
+ * ÿʱжаѵʱƽһ ȡʱϰ弶һ߹ʱ
+ * ûעʱÿƽһĵʱ Ⱦһ
+ * ʱжϸʱȼ1(Ϊ) ټ1 ߶ȡǰͬΪżһµֵ ض
+ * ڹж½ ϶߲ῴµһֵ ҲͲжпת Ҫڲжжȡ
+ */
+
+/**
+ * free-running counter registered by the board, e.g. the count of a hwtimer
+ */
+struct rt_clock_counter
+{
+    const char                 *name;                   /**< name of the counter */
+    rt_uint32_t (*read)(struct rt_clock_counter *counter);
+    rt_uint32_t                 mask;                   /**< valid bits, e.g. 0xffff for a 16-bit counter */
+    rt_uint32_t                 freq;                   /**< counting frequency, Hz */
+
+    rt_uint32_t                 mult;                   /**< ns = count * mult >> shift */
+    rt_uint32_t                 shift;
+};
+
+#if defined(__GNUC__)
+#define CLOCK_BARRIER()         __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#else
+/* ϶ֻᱻʱжϴ volatileʵȺ˳Ѿ㹻 */
+#define CLOCK_BARRIER()
+#endif /* defined(__GNUC__) */
+
+static volatile rt_uint32_t _clock_seq = 0;
+/* һʱĵʱ Լ1nsĲ */
+static volatile rt_uint64_t _clock_ns = 0;
+static volatile rt_uint32_t _clock_frac = 0;
+/* һʱֵ */
+static volatile rt_uint32_t _clock_last = 0;
+static struct rt_clock_counter *volatile _clock_counter = RT_NULL;
+
+/* ʱжƽʱ жϵ */
+static void _clock_update(void)
+{
+    struct rt_clock_counter *counter = _clock_counter;
+    rt_uint32_t now;
+    rt_uint64_t ns;
+
+    _clock_seq ++;
+    CLOCK_BARRIER();
+
+    if (counter != RT_NULL)
+    {
+        now = counter->read(counter);
+        ns  = (rt_uint64_t)((now - _clock_last) & counter->mask) * counter->mult + _clock_frac;
+        _clock_ns  += ns >> counter->shift;
+        _clock_frac = (rt_uint32_t)(ns & ((1ULL << counter->shift) - 1));
+        _clock_last = now;
+    }
+    else
+    {
+        /* 1/RT_TICK_PER_SECONDΪλۼ */
+        _clock_ns  += 1000000000UL / RT_TICK_PER_SECOND;
+        _clock_frac += 1000000000UL % RT_TICK_PER_SECOND;
+        if (_clock_frac >= RT_TICK_PER_SECOND)
+        {
+            _clock_ns ++;
+            _clock_frac -= RT_TICK_PER_SECOND;
+        }
+    }
+
+    CLOCK_BARRIER();
+    _clock_seq ++;
+}
+
+/* rt_tick_setĽ ʱ䲻ᵹ жϵ */
+static void _clock_advance(rt_tick_t ticks)
+{
+    struct rt_clock_counter *counter = _clock_counter;
+    rt_uint32_t now;
+    rt_uint64_t ns, elapsed;
+
+    /* ѽʱʱ䲻 */
+    if (ticks == 0 || ticks >= RT_TICK_MAX / 2)
+        return;
+
+    _clock_seq ++;
+    CLOCK_BARRIER();
+
+    if (counter != RT_NULL)
+    {
+        /* ʱѾ ƽ ڶѾʱ ֮ӵǰֵ¿ʼ */
+        now     = counter->read(counter);
+        elapsed = ((rt_uint64_t)((now - _clock_last) & counter->mask) * counter->mult + _clock_frac) >> counter->shift;
+        ns      = (rt_uint64_t)ticks * 1000000000UL / RT_TICK_PER_SECOND;
+        _clock_ns  += ns > elapsed ? ns : elapsed;
+        _clock_frac = 0;
+        _clock_last = now;
+    }
+    else
+    {
+        ns = (rt_uint64_t)ticks * (1000000000UL % RT_TICK_PER_SECOND) + _clock_frac;
+        _clock_ns  += (rt_uint64_t)ticks * (1000000000UL / RT_TICK_PER_SECOND) + ns / RT_TICK_PER_SECOND;
+        _clock_frac = (rt_uint32_t)(ns % RT_TICK_PER_SECOND);
+    }
+
+    CLOCK_BARRIER();
+    _clock_seq ++;
+}
+
+/**
+ * @brief This function will register a free-running counter to refine the
+ *        monotonic clock between ticks. The counter shall not wrap around
+ *        within two ticks.
+ *
+ * @param counter the counter, which shall stay valid after registered.
+ *
+ * @return the operation status, RT_EOK on successful, -RT_ERROR if the counter
+ *         wraps around too fast.
+ */
+rt_err_t rt_clock_counter_register(struct rt_clock_counter *counter)
+{
+    rt_base_t level;
+
+    RT_ASSERT(counter != RT_NULL);
+    RT_ASSERT(counter->read != RT_NULL);
+    RT_ASSERT(counter->freq != 0);
+
+    if ((rt_uint64_t)counter->mask * RT_TICK_PER_SECOND < 2ULL * counter->freq)
+        return -RT_ERROR;
+
+    /* ȡshift ʹmult32λ mult64λ */
+    counter->shift = 32;
+    while (counter->shift > 0 &&
+           (1000000000ULL << counter->shift) / counter->freq > 0xffffffffULL)
+        counter->shift --;
+    counter->mult = (rt_uint32_t)((1000000000ULL << counter->shift) / counter->freq);
+
+    /* ӵǰļ õʱ䵹 */
+    level = rt_hw_interrupt_disable();
+    _clock_seq ++;
+    CLOCK_BARRIER();
+    _clock_last    = counter->read(counter);
+    _clock_frac    = 0;
+    _clock_counter = counter;
+    CLOCK_BARRIER();
+    _clock_seq ++;
+    rt_hw_interrupt_enable(level);
+
+    return RT_EOK;
+}
+RTM_EXPORT(rt_clock_counter_register);
+
+/**
+ * @brief This function will return the monotonic time from startup in ns. It
+ *        never blocks and takes no lock, and can be invoked in interrupt service
+ *        routines, but not in non-maskable ones.
+ *
+ * @return the monotonic time in ns.
+ */
+rt_uint64_t rt_clock_monotonic_ns(void)
+{
+    struct rt_clock_counter *counter;
+    rt_uint32_t seq, frac, delta = 0;
+    rt_uint64_t ns;
+
+    do
+    {
+        seq = _clock_seq;
+        CLOCK_BARRIER();
+        ns      = _clock_ns;
+        frac    = _clock_frac;
+        counter = _clock_counter;
+        if (counter != RT_NULL)
+            delta = (counter->read(counter) - _clock_last) & counter->mask;
+        CLOCK_BARRIER();
+    } while ((seq & 1) || seq != _clock_seq);
+
+    if (counter != RT_NULL)
+        ns += ((rt_uint64_t)delta * counter->mult + frac) >> counter->shift;
+
+    return ns;
+}
+RTM_EXPORT(rt_clock_monotonic_ns);
+#endif /* RT_USING_CLOCK_MONOTONIC */
+
 #ifndef __on_rt_tick_hook
     #define __on_rt_tick_hook()          __ON_HOOK_ARGS(rt_tick_hook, ())
 #endif
@@ -68,7 +252,9 @@ rt_tick_t rt_tick_get(void)
 RTM_EXPORT(rt_tick_get);
 
 /**
- * @brief    This function will set current tick.
+ * @brief    This function will set current tick. With RT_USING_CLOCK_MONOTONIC,
+ *           the monotonic clock is advanced by the ticks skipped, e.g. after a
+ *           tickless sleep, and stays unchanged if the tick is set backwards.
  *
  * @param    tick is the value that you will set.
  */
@@ -78,6 +264,9 @@ void rt_tick_set(rt_tick_t tick)
     rt_base_t level;
 
     level = rt_hw_interrupt_disable();
+#ifdef RT_USING_CLOCK_MONOTONIC
+    _clock_advance(tick - rt_tick);
+#endif /* RT_USING_CLOCK_MONOTONIC */
     rt_tick = tick;
     rt_hw_interrupt_enable(level);
 }
@@ -97,6 +286,9 @@ void rt_tick_increase(void)
     level = rt_hw_interrupt_disable();
     /* ϵͳ */
     ++ rt_tick;
+#ifdef RT_USING_CLOCK_MONOTONIC
+    _clock_update();
+#endif /* RT_USING_CLOCK_MONOTONIC */
     /* ȡǰ߳̾ */
     thread = rt_thread_self();
     /* ʱƬԼ */
@@ -158,7 +350,8 @@ RTM_EXPORT(rt_tick_from_millisecond);
  *
  * @note     if the value of RT_TICK_PER_SECOND is lower than 1000 or
  *           is not an integral multiple of 1000, this function will not
- *           provide the correct 1ms-based tick.
+ *           provide the correct 1ms-based tick, unless RT_USING_CLOCK_MONOTONIC
+ *           is enabled.
  *
  * @return   Return passed millisecond from boot.
  */
@@ -167,6 +360,8 @@ rt_weak rt_tick_t rt_tick_get_millisecond(void)
 {
 #if 1000 % RT_TICK_PER_SECOND == 0u
     return rt_tick_get() * (1000u / RT_TICK_PER_SECOND);
+#elif defined(RT_USING_CLOCK_MONOTONIC)
+    return (rt_tick_t)(rt_clock_monotonic_ns() / 1000000);
 #else
     #warning "rt-thread cannot provide a correct 1ms-based tick any longer,\
     please redefine this function in another file by using a high-precision hard-timer."
@@ -104,6 +104,23 @@ rt_device_t rt_device_find(const char *name)
 }
 RTM_EXPORT(rt_device_find);
 
+#ifdef RT_USING_OBJECT_HANDLE
+/**
+ * @brief This function finds a device driver by its handle.
+ *
+ * @param handle is the handle of the device, which is got by rt_object_get_handle.
+ *
+ * @return the registered device driver on successful, or RT_NULL if the device
+ *         has been unregistered or the handle is not of a device.
+ */
+/* ͨ豸 */
+rt_device_t rt_device_from_handle(rt_uint32_t handle)
+{
+    return (rt_device_t)rt_object_from_handle(handle, RT_Object_Class_Device);
+}
+RTM_EXPORT(rt_device_from_handle);
+#endif /* RT_USING_OBJECT_HANDLE */
+
 #ifdef RT_USING_HEAP
 /**
  * @brief This function creates a device object with user data size.
@@ -183,7 +200,7 @@ rt_err_t rt_device_init(rt_device_t dev)
             if (result != RT_EOK)
             {
                 RT_DEBUG_LOG(RT_DEBUG_DEVICE, ("To initialize device:%s failed. The error code is %d\n",
-                           dev->parent.name, result));
+                           rt_object_get_name(&(dev->parent)), result));
             }
             else
             {   /* 豸ı־: */
@@ -226,7 +243,7 @@ rt_err_t rt_device_open(rt_device_t dev, rt_uint16_t oflag)
             if (result != RT_EOK)
             {
                 RT_DEBUG_LOG(RT_DEBUG_DEVICE, ("To initialize device:%s failed. The error code is %d\n",
-                           dev->parent.name, result));
+                           rt_object_get_name(&(dev->parent)), result));
                 /* 豸ʼ */
                 return result;
             }
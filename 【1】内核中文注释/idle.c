@@ -33,6 +33,45 @@ rt_align(RT_ALIGN_SIZE)
 /* ߳ջ */
 static rt_uint8_t idle_thread_stack[_CPUS_NR][IDLE_THREAD_STACK_SIZE];
 
+#ifdef RT_USING_THREAD_REAPER
+/*
+ * ߳
+ *
+ * ʬ̲߳ٵȿ̻߳ һȼĻ̷߳
+ * ÿڹж´ȡRT_THREAD_REAPER_BATCH߳ ڴͷŶڿжϺִ
+ * ɿձΪǿʱһӲʱ µʱû ʱ̵߳ȼһ
+ */
+#ifndef RT_THREAD_REAPER_PRIORITY
+#define RT_THREAD_REAPER_PRIORITY           (RT_THREAD_PRIORITY_MAX - 2)
+#endif
+#ifndef RT_THREAD_REAPER_URGENT_PRIORITY
+#define RT_THREAD_REAPER_URGENT_PRIORITY    1
+#endif
+#ifndef RT_THREAD_REAPER_BATCH
+#define RT_THREAD_REAPER_BATCH              8
+#endif
+/* ʬ߳ȴʱ */
+#ifndef RT_THREAD_REAPER_LATENCY
+#define RT_THREAD_REAPER_LATENCY            (RT_TICK_PER_SECOND / 10)
+#endif
+#ifndef RT_THREAD_REAPER_STACK_SIZE
+#define RT_THREAD_REAPER_STACK_SIZE         IDLE_THREAD_STACK_SIZE
+#endif
+
+static struct rt_thread _reaper_thread;
+rt_align(RT_ALIGN_SIZE)
+static rt_uint8_t _reaper_thread_stack[RT_THREAD_REAPER_STACK_SIZE];
+static struct rt_semaphore _reaper_sem;
+static struct rt_timer _reaper_timer;
+#endif /* RT_USING_THREAD_REAPER */
+
+
+#if defined(RT_USING_IDLE_WORK) || defined(RT_USING_IDLE_GOVERNOR)
+extern rt_uint32_t rt_thread_ready_priority_group;
+#endif /* defined(RT_USING_IDLE_WORK) || defined(RT_USING_IDLE_GOVERNOR) */
+#ifdef RT_USING_IDLE_GOVERNOR
+void rt_idle_governor_enter(void);
+#endif /* RT_USING_IDLE_GOVERNOR */
 
 static void (*idle_hook_list[RT_IDLE_HOOK_LIST_SIZE])(void);
 
@@ -113,7 +152,20 @@ rt_err_t rt_thread_idle_delhook(void (*hook)(void))
 /* ߳ڵ뽩ʬ߳ */
 void rt_thread_defunct_enqueue(rt_thread_t thread)
 {
+#ifdef RT_USING_THREAD_REAPER
+    rt_bool_t was_empty = rt_list_isempty(&_rt_thread_defunct);
+#endif /* RT_USING_THREAD_REAPER */
+
     rt_list_insert_after(&_rt_thread_defunct, &thread->tlist);
+
+#ifdef RT_USING_THREAD_REAPER
+    /* ɿձΪǿʱʼȴʱ ٻѻ߳ ߳ʱʱ */
+    if (was_empty)
+    {
+        rt_timer_start(&_reaper_timer);
+        rt_sem_release(&_reaper_sem);
+    }
+#endif /* RT_USING_THREAD_REAPER */
 }
 
 /**
@@ -143,6 +195,7 @@ rt_thread_t rt_thread_defunct_dequeue(void)
     return thread;
 }
 
+#ifndef RT_USING_THREAD_REAPER
 /**
  * @brief This function will perform system background job when system idle.
  */
@@ -183,6 +236,11 @@ static void rt_defunct_execute(void)
         /* if need free, delete it */
         if (object_is_systemobject == RT_FALSE)
         {
+#ifdef RT_USING_THREAD_CACHE
+            /* ̻߳ һrt_thread_create */
+            if (rt_thread_cache_put(thread) == RT_EOK)
+                continue;
+#endif /* RT_USING_THREAD_CACHE */
             /* ͷ߳ջ */
             RT_KERNEL_FREE(thread->stack_addr);
             /* ɾ̶߳ */
@@ -191,6 +249,440 @@ static void rt_defunct_execute(void)
 #endif
     }
 }
+#endif /* RT_USING_THREAD_REAPER */
+
+#ifdef RT_USING_THREAD_REAPER
+/* ӽʬ߳βȡcount߳ ִͷڴ ȡĸ */
+static rt_ubase_t _reaper_reclaim(rt_ubase_t count)
+{
+    rt_base_t level;
+    rt_ubase_t number;
+    rt_list_t batch, *node;
+    rt_thread_t thread;
+
+    rt_list_init(&batch);
+
+    /* жϵʱֻժڵ */
+    level = rt_hw_interrupt_disable();
+    for (number = 0; number < count && !rt_list_isempty(&_rt_thread_defunct); number ++)
+    {
+        node = _rt_thread_defunct.prev;
+        rt_list_remove(node);
+        rt_list_insert_before(&batch, node);
+    }
+    rt_hw_interrupt_enable(level);
+
+    /* ̵ִ߳ ̬߳thread.cֱӷ 뽩ʬ߳ */
+    for (node = batch.next; node != &batch; node = node->next)
+    {
+        thread = rt_list_entry(node, struct rt_thread, tlist);
+
+        if (thread->cleanup != RT_NULL)
+        {
+            thread->cleanup(thread);
+        }
+    }
+
+    /* ټͷŶ̵̬߳ջͿƿ */
+    while (!rt_list_isempty(&batch))
+    {
+        thread = rt_list_entry(batch.next, struct rt_thread, tlist);
+        rt_list_remove(&(thread->tlist));
+#ifdef RT_USING_HEAP
+#ifdef RT_USING_THREAD_CACHE
+        if (rt_thread_cache_put(thread) == RT_EOK)
+            continue;
+#endif /* RT_USING_THREAD_CACHE */
+        RT_KERNEL_FREE(thread->stack_addr);
+        rt_object_delete((rt_object_t)thread);
+#endif /* RT_USING_HEAP */
+    }
+
+    return number;
+}
+
+/* ȴʱнʬ߳ ˵̱߳ȼ߳ռס ʱȼ */
+static void _reaper_timeout(void *parameter)
+{
+    rt_uint8_t priority = RT_THREAD_REAPER_URGENT_PRIORITY;
+
+    if (!rt_list_isempty(&_rt_thread_defunct))
+    {
+        rt_thread_control(&_reaper_thread, RT_THREAD_CTRL_CHANGE_PRIORITY, &priority);
+        rt_schedule();
+    }
+}
+
+/* ߳ں */
+static void _reaper_thread_entry(void *parameter)
+{
+    rt_uint8_t priority = RT_THREAD_REAPER_PRIORITY;
+
+    while (1)
+    {
+        rt_sem_take(&_reaper_sem, RT_WAITING_FOREVER);
+
+        while (_reaper_reclaim(RT_THREAD_REAPER_BATCH) != 0)
+        {
+            /* ȼֻһ ʣµ¼ʱ */
+            if (_reaper_thread.current_priority != RT_THREAD_REAPER_PRIORITY)
+            {
+                rt_thread_control(&_reaper_thread, RT_THREAD_CTRL_CHANGE_PRIORITY, &priority);
+                if (!rt_list_isempty(&_rt_thread_defunct))
+                    rt_timer_start(&_reaper_timer);
+                rt_schedule();
+            }
+        }
+    }
+}
+#endif /* RT_USING_THREAD_REAPER */
+
+#ifdef RT_USING_IDLE_WORK
+/*
+ * 
+ *
+ * Ѳĺ̨(ϲڴ ɨ߳ջ ͳƵ)ڿִ߳
+ * ÿȼԤ ߳ÿְȼȡ ۼƿԤͣ һ
+ * ֮Ƿ߳̾ оó ε֮䱻 ִеһ
+ * Ҫֶɵ񷵻-RT_EBUSY ŵͬһȼĶβ
+ * ʱû¿񷵻-RT_EEMPTY ͣŵһٷŻض ֻʣͣŵʱCPU˯
+ */
+#ifdef RT_USING_SMP
+#error "idle work queue does not support SMP"
+#endif /* RT_USING_SMP */
+
+#ifndef RT_IDLE_WORK_PRIO_NR
+#define RT_IDLE_WORK_PRIO_NR            4
+#endif
+/* ÿֵĿԤ λԤͬ ΢ */
+#ifndef RT_IDLE_WORK_BUDGET
+#define RT_IDLE_WORK_BUDGET             1000
+#endif
+
+#define RT_IDLE_WORK_PENDING            0x01    /**< work is in the queue */
+#define RT_IDLE_WORK_PARKED             0x02    /**< nothing to do, waits for the next round */
+
+/**
+ * work item executed by the idle thread
+ */
+struct rt_idle_work
+{
+    rt_list_t                   list;                   /**< node in the queue */
+
+    rt_err_t (*func)(struct rt_idle_work *work, void *parameter);
+    void                       *parameter;              /**< parameter of func */
+
+    rt_uint16_t                 cost;                   /**< estimated cost of one call */
+    rt_uint8_t                  priority;               /**< 0 is the highest */
+    rt_uint8_t                  flag;                   /**< RT_IDLE_WORK_PENDING/PARKED */
+
+    rt_uint32_t                 run_count;              /**< number of calls */
+};
+
+/* ÿȼһ λͼеλʾӦзǿ */
+static rt_list_t _idle_work_queue[RT_IDLE_WORK_PRIO_NR];
+static rt_uint32_t _idle_work_ready = 0;
+/* û¿ λͼ */
+static rt_list_t _idle_work_parked;
+/*
+ * ִеǷִڼ䱻ȡ
+ * غ ѱͷ ״̬ܼ
+ */
+static struct rt_idle_work *_idle_work_running = RT_NULL;
+static rt_bool_t _idle_work_canceled = RT_FALSE;
+
+/* ŵȼĶβ жϵ */
+static void _idle_work_enqueue(struct rt_idle_work *work)
+{
+    rt_list_insert_before(&_idle_work_queue[work->priority], &(work->list));
+    _idle_work_ready |= 1UL << work->priority;
+    work->flag |= RT_IDLE_WORK_PENDING;
+}
+
+/* ͣŵһ жϵ */
+static void _idle_work_park(struct rt_idle_work *work)
+{
+    rt_list_insert_before(&_idle_work_parked, &(work->list));
+    work->flag |= RT_IDLE_WORK_PENDING | RT_IDLE_WORK_PARKED;
+}
+
+/* ӶлͣƳ жϵ */
+static void _idle_work_dequeue(struct rt_idle_work *work)
+{
+    rt_list_remove(&(work->list));
+    if (!(work->flag & RT_IDLE_WORK_PARKED) && rt_list_isempty(&_idle_work_queue[work->priority]))
+        _idle_work_ready &= ~(1UL << work->priority);
+    work->flag &= ~(RT_IDLE_WORK_PENDING | RT_IDLE_WORK_PARKED);
+}
+
+/**
+ * @brief This function will initialize an idle work.
+ *
+ * @param work the work to be initialized.
+ *
+ * @param func the work function. It returns -RT_EBUSY to be called again later,
+ *        -RT_EEMPTY if it has nothing to do for now and shall be called again in
+ *        the next round, that is after the cpu wakes up. Any other value finishes
+ *        the work. The work is not touched after it is finished, so func may
+ *        release it before returning.
+ *
+ * @param parameter the parameter of the work function.
+ *
+ * @param priority the priority of the work, 0 is the highest.
+ *
+ * @param cost the estimated cost of one call, in the unit of RT_IDLE_WORK_BUDGET.
+ */
+void rt_idle_work_init(struct rt_idle_work *work,
+                       rt_err_t (*func)(struct rt_idle_work *work, void *parameter),
+                       void *parameter, rt_uint8_t priority, rt_uint16_t cost)
+{
+    RT_ASSERT(work != RT_NULL);
+    RT_ASSERT(func != RT_NULL);
+    RT_ASSERT(priority < RT_IDLE_WORK_PRIO_NR);
+
+    rt_list_init(&(work->list));
+    work->func      = func;
+    work->parameter = parameter;
+    work->priority  = priority;
+    /* Ϊ1 ֤ÿִеĴ */
+    work->cost      = cost ? cost : 1;
+    work->flag      = 0;
+    work->run_count = 0;
+}
+RTM_EXPORT(rt_idle_work_init);
+
+/**
+ * @brief This function will put an idle work into the queue. It can be invoked
+ *        in interrupt service routines. A parked work is queued again at once.
+ *
+ * @param work the work.
+ *
+ * @return the operation status, RT_EOK on successful, -RT_EBUSY if the work is
+ *         already in the queue.
+ */
+rt_err_t rt_idle_work_submit(struct rt_idle_work *work)
+{
+    rt_base_t level;
+    rt_err_t result = RT_EOK;
+
+    RT_ASSERT(work != RT_NULL);
+
+    level = rt_hw_interrupt_disable();
+    if (work->flag & RT_IDLE_WORK_PARKED)
+    {
+        /* ͣŵ¿ */
+        _idle_work_dequeue(work);
+        _idle_work_enqueue(work);
+    }
+    else if (work->flag & RT_IDLE_WORK_PENDING)
+    {
+        result = -RT_EBUSY;
+    }
+    else
+    {
+        if (work == _idle_work_running)
+            _idle_work_canceled = RT_FALSE;
+        _idle_work_enqueue(work);
+    }
+    rt_hw_interrupt_enable(level);
+
+    return result;
+}
+RTM_EXPORT(rt_idle_work_submit);
+
+/**
+ * @brief This function will remove an idle work from the queue. A running work
+ *        is not called again after it returns.
+ *
+ * @param work the work.
+ *
+ * @return the operation status, RT_EOK on successful, -RT_EBUSY if the work
+ *         function is running and the work can't be released yet.
+ */
+rt_err_t rt_idle_work_cancel(struct rt_idle_work *work)
+{
+    rt_base_t level;
+    rt_err_t result = RT_EOK;
+
+    RT_ASSERT(work != RT_NULL);
+
+    level = rt_hw_interrupt_disable();
+    if (work->flag & RT_IDLE_WORK_PENDING)
+        _idle_work_dequeue(work);
+    if (work == _idle_work_running)
+    {
+        _idle_work_canceled = RT_TRUE;
+        result = -RT_EBUSY;
+    }
+    rt_hw_interrupt_enable(level);
+
+    return result;
+}
+RTM_EXPORT(rt_idle_work_cancel);
+
+/* ߳ÿִһ ֱΪ Ԥ߳̾ */
+static void _idle_work_execute(void)
+{
+    rt_base_t level;
+    rt_uint32_t spent = 0;
+    rt_err_t result;
+    struct rt_idle_work *work;
+
+    /* һͣŵŻض */
+    level = rt_hw_interrupt_disable();
+    while (!rt_list_isempty(&_idle_work_parked))
+    {
+        work = rt_list_entry(_idle_work_parked.next, struct rt_idle_work, list);
+        _idle_work_dequeue(work);
+        _idle_work_enqueue(work);
+    }
+    rt_hw_interrupt_enable(level);
+
+    while (1)
+    {
+        level = rt_hw_interrupt_disable();
+        /* ʱ߳̿ܵס˾߳ */
+        if (_idle_work_ready == 0 ||
+            (rt_thread_ready_priority_group & ~idle_thread[0].number_mask) != 0)
+        {
+            rt_hw_interrupt_enable(level);
+            break;
+        }
+
+        work = rt_list_entry(_idle_work_queue[__rt_ffs(_idle_work_ready) - 1].next,
+                             struct rt_idle_work, list);
+        /* Ѿִй ʣԤ㲻һ */
+        if (spent != 0 && spent + work->cost > RT_IDLE_WORK_BUDGET)
+        {
+            rt_hw_interrupt_enable(level);
+            break;
+        }
+        _idle_work_dequeue(work);
+        /* غѱͷ ҪϢڵǰȡ */
+        work->run_count ++;
+        spent += work->cost;
+        _idle_work_running  = work;
+        _idle_work_canceled = RT_FALSE;
+        rt_hw_interrupt_enable(level);
+
+        result = work->func(work, work->parameter);
+
+        level = rt_hw_interrupt_disable();
+        _idle_work_running = RT_NULL;
+        /* ֻлҪִеܷ ִڼ䱻ȡύĲظ */
+        if ((result == -RT_EBUSY || result == -RT_EEMPTY) &&
+            !_idle_work_canceled && !(work->flag & RT_IDLE_WORK_PENDING))
+        {
+            if (result == -RT_EBUSY)
+                _idle_work_enqueue(work);
+            else
+                _idle_work_park(work);
+        }
+        rt_hw_interrupt_enable(level);
+    }
+}
+
+/*
+ * ԭÿֱֶӵõĺ̨ Ϊȼĳפ
+ * ûбɵʱ ʣ๤ʱŶ һͣŵһ CPUһֱ
+ */
+#ifdef RT_USING_THREAD_STACK_LAZY_PAINT
+static struct rt_idle_work _idle_work_stack_scan;
+static rt_err_t _idle_work_stack_scan_step(struct rt_idle_work *work, void *parameter)
+{
+    return rt_thread_stack_scan_step();
+}
+#endif /* RT_USING_THREAD_STACK_LAZY_PAINT */
+
+#ifdef RT_USING_SMALL_MEM_DEFER
+static struct rt_idle_work _idle_work_smem_defer;
+static rt_err_t _idle_work_smem_defer_step(struct rt_idle_work *work, void *parameter)
+{
+    return rt_smem_defer_step();
+}
+#endif /* RT_USING_SMALL_MEM_DEFER */
+
+#ifdef RT_USING_SMALL_MEM_GUARD
+static struct rt_idle_work _idle_work_smem_guard;
+static rt_err_t _idle_work_smem_guard_step(struct rt_idle_work *work, void *parameter)
+{
+    return rt_smem_guard_step();
+}
+#endif /* RT_USING_SMALL_MEM_GUARD */
+
+static void _idle_work_system_init(void)
+{
+    rt_ubase_t i;
+
+    for (i = 0; i < RT_IDLE_WORK_PRIO_NR; i ++)
+        rt_list_init(&_idle_work_queue[i]);
+    rt_list_init(&_idle_work_parked);
+
+#ifdef RT_USING_THREAD_STACK_LAZY_PAINT
+    rt_idle_work_init(&_idle_work_stack_scan, _idle_work_stack_scan_step, RT_NULL,
+                      RT_IDLE_WORK_PRIO_NR - 1, RT_IDLE_WORK_BUDGET / 10);
+    rt_idle_work_submit(&_idle_work_stack_scan);
+#endif /* RT_USING_THREAD_STACK_LAZY_PAINT */
+#ifdef RT_USING_SMALL_MEM_DEFER
+    rt_idle_work_init(&_idle_work_smem_defer, _idle_work_smem_defer_step, RT_NULL,
+                      RT_IDLE_WORK_PRIO_NR - 1, RT_IDLE_WORK_BUDGET / 10);
+    rt_idle_work_submit(&_idle_work_smem_defer);
+#endif /* RT_USING_SMALL_MEM_DEFER */
+#ifdef RT_USING_SMALL_MEM_GUARD
+    rt_idle_work_init(&_idle_work_smem_guard, _idle_work_smem_guard_step, RT_NULL,
+                      RT_IDLE_WORK_PRIO_NR - 1, RT_IDLE_WORK_BUDGET / 10);
+    rt_idle_work_submit(&_idle_work_smem_guard);
+#endif /* RT_USING_SMALL_MEM_GUARD */
+}
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+
+/* ӡе */
+static int list_idle_work(void)
+{
+    rt_ubase_t i, index, count;
+    rt_base_t level;
+    rt_list_t *queue;
+    struct rt_list_node *node;
+    struct rt_idle_work *work;
+    struct rt_idle_work copy;
+
+    rt_kprintf("prio func       cost  runs       state\n");
+    /* һͣ */
+    for (i = 0; i <= RT_IDLE_WORK_PRIO_NR; i ++)
+    {
+        queue = i < RT_IDLE_WORK_PRIO_NR ? &_idle_work_queue[i] : &_idle_work_parked;
+        /* ÿιжֻһ ӡʱжǴ򿪵 ܱ֮仯 */
+        for (index = 0; ; index ++)
+        {
+            count = 0;
+            work  = RT_NULL;
+            level = rt_hw_interrupt_disable();
+            rt_list_for_each(node, queue)
+            {
+                if (count ++ == index)
+                {
+                    work = rt_list_entry(node, struct rt_idle_work, list);
+                    copy = *work;
+                    break;
+                }
+            }
+            rt_hw_interrupt_enable(level);
+            if (work == RT_NULL)
+                break;
+
+            rt_kprintf("%-4d 0x%08x %-5d %-10d %s\n", copy.priority, copy.func, copy.cost, copy.run_count,
+                       (copy.flag & RT_IDLE_WORK_PARKED) ? "parked" : "ready");
+        }
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT(list_idle_work, show idle work queue);
+#endif /* RT_USING_FINSH */
+#endif /* RT_USING_IDLE_WORK */
+
 /* ߳ں */
 static void idle_thread_entry(void *parameter)
 {
@@ -213,9 +705,52 @@ static void idle_thread_entry(void *parameter)
         }
 #endif /* RT_USING_IDLE_HOOK */
 
-#ifndef RT_USING_SMP
+#if !defined(RT_USING_SMP) && !defined(RT_USING_THREAD_REAPER)
         rt_defunct_execute();
-#endif /* RT_USING_SMP */
+#endif /* !defined(RT_USING_SMP) && !defined(RT_USING_THREAD_REAPER) */
+
+#ifdef RT_USING_OBJECT_REF
+        /* ͷжзŵһõĶ */
+        rt_object_reclaim();
+#endif /* RT_USING_OBJECT_REF */
+
+#ifdef RT_USING_IDLE_WORK
+        /* ȼԤִк̨ */
+        _idle_work_execute();
+#else
+#if defined(RT_USING_THREAD_STACK_LAZY_PAINT) && !defined(RT_USING_SMP)
+        /* Ϊ̵߳ջͿɫ ¸߳ջʹ */
+        rt_thread_stack_scan_step();
+#endif /* defined(RT_USING_THREAD_STACK_LAZY_PAINT) && !defined(RT_USING_SMP) */
+
+#if defined(RT_USING_SMALL_MEM_DEFER) && !defined(RT_USING_SMP)
+        /* ϲӳͷŵڴ */
+        rt_smem_defer_step();
+#endif /* defined(RT_USING_SMALL_MEM_DEFER) && !defined(RT_USING_SMP) */
+
+#if defined(RT_USING_SMALL_MEM_GUARD) && !defined(RT_USING_SMP)
+        /* ڴ汣 */
+        rt_smem_guard_step();
+#endif /* defined(RT_USING_SMALL_MEM_GUARD) && !defined(RT_USING_SMP) */
+#endif /* RT_USING_IDLE_WORK */
+
+#if defined(RT_USING_IDLE_GOVERNOR) && !defined(RT_USING_SMP)
+        {
+            rt_base_t level;
+
+            /* жϺȷû߳̾ Ҳûк̨(ͣŵĲ) ֮жϻCPU */
+            level = rt_hw_interrupt_disable();
+            if ((rt_thread_ready_priority_group & ~idle_thread[0].number_mask) == 0
+#ifdef RT_USING_IDLE_WORK
+                && _idle_work_ready == 0
+#endif /* RT_USING_IDLE_WORK */
+               )
+            {
+                rt_idle_governor_enter();
+            }
+            rt_hw_interrupt_enable(level);
+        }
+#endif /* defined(RT_USING_IDLE_GOVERNOR) && !defined(RT_USING_SMP) */
     }
 }
 
@@ -230,6 +765,10 @@ void rt_thread_idle_init(void)
     rt_ubase_t i;
     /* ߳ */
     char idle_thread_name[RT_NAME_MAX];
+
+#ifdef RT_USING_IDLE_WORK
+    _idle_work_system_init();
+#endif /* RT_USING_IDLE_WORK */
     /* ѯ߳ */
     for (i = 0; i < _CPUS_NR; i++)
     {
@@ -245,6 +784,23 @@ void rt_thread_idle_init(void)
         /* ߳ */
         rt_thread_startup(&idle_thread[i]);
     }
+
+#ifdef RT_USING_THREAD_REAPER
+    RT_ASSERT(RT_THREAD_REAPER_PRIORITY < RT_THREAD_PRIORITY_MAX - 1);
+
+    rt_sem_init(&_reaper_sem, "reaper", 0, RT_IPC_FLAG_FIFO);
+    rt_timer_init(&_reaper_timer, "reaper", _reaper_timeout, RT_NULL,
+                  RT_THREAD_REAPER_LATENCY, RT_TIMER_FLAG_ONE_SHOT | RT_TIMER_FLAG_HARD_TIMER);
+    rt_thread_init(&_reaper_thread,
+            "treaper",
+            _reaper_thread_entry,
+            RT_NULL,
+            &_reaper_thread_stack[0],
+            sizeof(_reaper_thread_stack),
+            RT_THREAD_REAPER_PRIORITY,
+            32);
+    rt_thread_startup(&_reaper_thread);
+#endif /* RT_USING_THREAD_REAPER */
 }
 
 /**
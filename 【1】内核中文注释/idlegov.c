@@ -0,0 +1,373 @@
+/*
+ * Copyright (c) 2006-2022, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * 空闲调控器
+ *
+ * 板级代码注册若干低功耗状态 每个状态给出退出延迟和收支平衡时间(进入和退出的开销被省下的功耗抵消所需的最短停留时间)
+ * 空闲线程没有其他工作时 调控器预测这次空闲会持续多久 选一个不亏本 退出延迟又不超过线程要求的最深状态
+ * 预测取下一个定时器的到期时间和最近几次实际空闲时间的典型值中较小的一个
+ * 最近的空闲时间波动较大时 去掉最大的几个再看 仍不稳定就取其中第二小的值
+ * 预测比所有状态的收支平衡时间都短时 仍进入满足延迟要求的最浅状态 记录下实际的空闲时间
+ * 周期性的系统节拍最晚一个节拍后就会把CPU唤醒 预测不超过一个节拍
+ * 板级代码在enter()中停掉系统节拍 醒来后用rt_tick_set补上睡过的节拍时 定义RT_IDLE_GOVERNOR_TICKLESS去掉这个限制
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#ifdef RT_USING_IDLE_GOVERNOR
+
+#ifndef RT_IDLE_STATE_MAX
+#define RT_IDLE_STATE_MAX               4
+#endif
+/* 记录的最近空闲时间的个数 */
+#ifndef RT_IDLE_GOVERNOR_HISTORY
+#define RT_IDLE_GOVERNOR_HISTORY        8
+#endif
+
+/* 记录的空闲时间的上限 计算方差时不会溢出 */
+#define IDLE_SAMPLE_MAX                 0x0fffffffU
+
+/**
+ * low power state registered by the board
+ */
+struct rt_idle_state
+{
+    const char                 *name;                   /**< name of the state */
+    rt_uint32_t                 exit_latency;           /**< us from the wakeup event to running code */
+    rt_uint32_t                 target_residency;       /**< us to stay at least, so that the state saves energy */
+
+    /*
+     * enter the state and stay there until an interrupt or at most timeout us.
+     * It is called and returns with interrupts disabled, and returns the time
+     * actually spent in the state in us.
+     */
+    rt_uint32_t (*enter)(struct rt_idle_state *state, rt_uint32_t timeout);
+
+    rt_uint32_t                 usage;                  /**< times entered */
+    rt_uint32_t                 early;                  /**< times left before target_residency */
+    rt_uint64_t                 residency;              /**< total time spent in the state, us */
+};
+
+/**
+ * wakeup latency requirement of a thread or a driver
+ */
+struct rt_idle_latency
+{
+    rt_list_t                   list;
+    rt_uint32_t                 latency;                /**< us */
+};
+
+/* 按收支平衡时间从短到长排列 序号越大状态越深 */
+static struct rt_idle_state *_idle_state[RT_IDLE_STATE_MAX];
+static rt_uint8_t _idle_state_nr = 0;
+
+static rt_list_t _idle_latency_list = RT_LIST_OBJECT_INIT(_idle_latency_list);
+/* 所有要求中最小的退出延迟 */
+static rt_uint32_t _idle_latency_limit = RT_UINT32_MAX;
+
+/* 最近的实际空闲时间 环形存放 */
+static rt_uint32_t _idle_history[RT_IDLE_GOVERNOR_HISTORY];
+static rt_uint8_t _idle_history_index = 0;
+static rt_uint8_t _idle_history_nr = 0;
+
+/* 睡得太浅的次数: 实际空闲时间够进入更深的状态 */
+static rt_uint32_t _idle_too_shallow = 0;
+
+/**
+ * @brief This function will register a low power state to the idle governor.
+ *
+ * @param state the state, which shall stay valid after registered.
+ *
+ * @return the operation status, RT_EOK on successful, -RT_EFULL if there are
+ *         already RT_IDLE_STATE_MAX states.
+ */
+rt_err_t rt_idle_state_register(struct rt_idle_state *state)
+{
+    int index;
+    rt_base_t level;
+    rt_err_t result = RT_EOK;
+
+    RT_ASSERT(state != RT_NULL);
+    RT_ASSERT(state->enter != RT_NULL);
+
+    state->usage     = 0;
+    state->early     = 0;
+    state->residency = 0;
+
+    level = rt_hw_interrupt_disable();
+    if (_idle_state_nr >= RT_IDLE_STATE_MAX)
+    {
+        result = -RT_EFULL;
+    }
+    else
+    {
+        /* 插入排序 */
+        for (index = _idle_state_nr; index > 0; index --)
+        {
+            if (_idle_state[index - 1]->target_residency <= state->target_residency)
+                break;
+            _idle_state[index] = _idle_state[index - 1];
+        }
+        _idle_state[index] = state;
+        _idle_state_nr ++;
+    }
+    rt_hw_interrupt_enable(level);
+
+    return result;
+}
+RTM_EXPORT(rt_idle_state_register);
+
+/* 重新计算最小的退出延迟要求 需关中断调用 */
+static void _idle_latency_update(void)
+{
+    struct rt_list_node *node;
+    struct rt_idle_latency *request;
+
+    _idle_latency_limit = RT_UINT32_MAX;
+    rt_list_for_each(node, &_idle_latency_list)
+    {
+        request = rt_list_entry(node, struct rt_idle_latency, list);
+        if (request->latency < _idle_latency_limit)
+            _idle_latency_limit = request->latency;
+    }
+}
+
+/**
+ * @brief This function will limit the exit latency of the low power states
+ *        the idle governor may choose, until the request is released. To change
+ *        the latency, release the request and make it again.
+ *
+ * @param request the request, which shall stay valid until released.
+ *
+ * @param latency the maximum exit latency allowed, in us.
+ */
+void rt_idle_latency_request(struct rt_idle_latency *request, rt_uint32_t latency)
+{
+    rt_base_t level;
+
+    RT_ASSERT(request != RT_NULL);
+
+    request->latency = latency;
+
+    level = rt_hw_interrupt_disable();
+    rt_list_insert_after(&_idle_latency_list, &(request->list));
+    if (latency < _idle_latency_limit)
+        _idle_latency_limit = latency;
+    rt_hw_interrupt_enable(level);
+}
+RTM_EXPORT(rt_idle_latency_request);
+
+/**
+ * @brief This function will release a latency request.
+ *
+ * @param request the request.
+ */
+void rt_idle_latency_release(struct rt_idle_latency *request)
+{
+    rt_base_t level;
+
+    RT_ASSERT(request != RT_NULL);
+
+    level = rt_hw_interrupt_disable();
+    rt_list_remove(&(request->list));
+    _idle_latency_update();
+    rt_hw_interrupt_enable(level);
+}
+RTM_EXPORT(rt_idle_latency_release);
+
+/*
+ * 由最近的空闲时间预测典型值 记录不满时返回RT_UINT32_MAX
+ * 方差小于平均值平方的1/36(标准差小于平均值的1/6)视为稳定 否则去掉最大的一个再算 最多去掉1/4
+ */
+static rt_uint32_t _idle_predict(void)
+{
+    int index, count;
+    rt_uint32_t limit = RT_UINT32_MAX, max, min, second;
+    rt_uint64_t sum, avg, variance, diff;
+
+    if (_idle_history_nr < RT_IDLE_GOVERNOR_HISTORY)
+        return RT_UINT32_MAX;
+
+    while (1)
+    {
+        sum = 0;
+        max = 0;
+        count = 0;
+        for (index = 0; index < RT_IDLE_GOVERNOR_HISTORY; index ++)
+        {
+            if (_idle_history[index] <= limit)
+            {
+                sum += _idle_history[index];
+                if (_idle_history[index] > max)
+                    max = _idle_history[index];
+                count ++;
+            }
+        }
+        if (count == 0)
+            return RT_UINT32_MAX;
+        avg = sum / count;
+
+        variance = 0;
+        for (index = 0; index < RT_IDLE_GOVERNOR_HISTORY; index ++)
+        {
+            if (_idle_history[index] <= limit)
+            {
+                diff = _idle_history[index] > avg ? _idle_history[index] - avg : avg - _idle_history[index];
+                variance += diff * diff;
+            }
+        }
+        variance /= count;
+
+        if (variance <= avg * avg / 36)
+            return (rt_uint32_t)avg;
+
+        if (count * 4 <= RT_IDLE_GOVERNOR_HISTORY * 3 || max == 0)
+            break;
+        /* 去掉最大的值 */
+        limit = max - 1;
+    }
+
+    /* 仍不稳定 取第二小的值 宁可睡得浅一些 */
+    min = second = RT_UINT32_MAX;
+    for (index = 0; index < RT_IDLE_GOVERNOR_HISTORY; index ++)
+    {
+        if (_idle_history[index] < min)
+        {
+            second = min;
+            min = _idle_history[index];
+        }
+        else if (_idle_history[index] < second)
+        {
+            second = _idle_history[index];
+        }
+    }
+
+    return second;
+}
+
+/* 系统节拍数换算成微秒 */
+static rt_uint32_t _idle_tick_to_us(rt_tick_t tick)
+{
+    rt_uint64_t us = (rt_uint64_t)tick * 1000000 / RT_TICK_PER_SECOND;
+
+    return us > RT_UINT32_MAX ? RT_UINT32_MAX : (rt_uint32_t)us;
+}
+
+/**
+ * @brief This function will put the cpu into the deepest low power state that
+ *        pays off for the predicted idle time and meets all the latency requests.
+ *        If no state pays off, the shallowest state meeting the latency requests
+ *        is taken, so that the actual idle time is still recorded.
+ *        The periodic tick wakes the cpu within one tick, so the predicted idle
+ *        time is at most one tick, unless RT_IDLE_GOVERNOR_TICKLESS is defined:
+ *        then the enter function of every state shall stop the tick and add the
+ *        ticks slept with rt_tick_set after the wakeup.
+ *        It is invoked by the idle thread with interrupts disabled, when no
+ *        thread is ready, and returns after the cpu wakes up.
+ */
+void rt_idle_governor_enter(void)
+{
+    int index;
+    rt_tick_t now, next;
+    rt_uint32_t timer_us, predict_us, slept;
+    struct rt_idle_state *state = RT_NULL;
+
+    if (_idle_state_nr == 0)
+        return;
+
+    /* 距离下一个定时器到期的时间 已经到期的定时器马上就要处理 */
+    now  = rt_tick_get();
+    next = rt_timer_next_timeout_tick();
+    if (next == RT_TICK_MAX)
+        timer_us = RT_UINT32_MAX;
+    else if (next - now >= RT_TICK_MAX / 2)
+        return;
+    else
+        timer_us = _idle_tick_to_us(next - now);
+
+    predict_us = _idle_predict();
+    if (predict_us > timer_us)
+        predict_us = timer_us;
+#ifndef RT_IDLE_GOVERNOR_TICKLESS
+    /* 下一个系统节拍在一个节拍之内到来 */
+    if (predict_us > _idle_tick_to_us(1))
+        predict_us = _idle_tick_to_us(1);
+#endif /* RT_IDLE_GOVERNOR_TICKLESS */
+
+    /* 从最深的状态往浅找 */
+    for (index = _idle_state_nr - 1; index >= 0; index --)
+    {
+        if (_idle_state[index]->target_residency <= predict_us &&
+            _idle_state[index]->exit_latency <= _idle_latency_limit)
+        {
+            state = _idle_state[index];
+            break;
+        }
+    }
+    /* 不进入任何状态就没有新的记录 预测会一直偏短 CPU再也不会睡眠 */
+    if (state == RT_NULL)
+    {
+        for (index = 0; index < _idle_state_nr; index ++)
+        {
+            if (_idle_state[index]->exit_latency <= _idle_latency_limit)
+            {
+                state = _idle_state[index];
+                break;
+            }
+        }
+        /* 所有状态的退出延迟都太长 */
+        if (state == RT_NULL)
+            return;
+    }
+
+    slept = state->enter(state, timer_us);
+
+    state->usage ++;
+    state->residency += slept;
+    if (slept < state->target_residency)
+        state->early ++;
+    /* 更深一级的状态也能满足要求 说明预测偏短 */
+    if (index + 1 < _idle_state_nr &&
+        _idle_state[index + 1]->target_residency <= slept &&
+        _idle_state[index + 1]->exit_latency <= _idle_latency_limit)
+        _idle_too_shallow ++;
+
+    _idle_history[_idle_history_index] = slept < IDLE_SAMPLE_MAX ? slept : IDLE_SAMPLE_MAX;
+    _idle_history_index = (_idle_history_index + 1) % RT_IDLE_GOVERNOR_HISTORY;
+    if (_idle_history_nr < RT_IDLE_GOVERNOR_HISTORY)
+        _idle_history_nr ++;
+}
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+
+/* 打印各低功耗状态的使用情况 */
+static int list_idle_state(void)
+{
+    int index;
+    struct rt_idle_state *state;
+
+    rt_kprintf("%-*.*s latency  target   usage    early    residency(ms)\n",
+               RT_NAME_MAX, RT_NAME_MAX, "state");
+    for (index = 0; index < _idle_state_nr; index ++)
+    {
+        state = _idle_state[index];
+        rt_kprintf("%-*.*s %-8d %-8d %-8d %-8d %d\n",
+                   RT_NAME_MAX, RT_NAME_MAX, state->name,
+                   state->exit_latency, state->target_residency,
+                   state->usage, state->early, (rt_uint32_t)(state->residency / 1000));
+    }
+    rt_kprintf("latency limit: %d, too shallow: %d\n",
+               _idle_latency_limit == RT_UINT32_MAX ? -1 : (int)_idle_latency_limit, _idle_too_shallow);
+
+    return 0;
+}
+MSH_CMD_EXPORT(list_idle_state, show low power state usage);
+#endif /* RT_USING_FINSH */
+
+#endif /* RT_USING_IDLE_GOVERNOR */
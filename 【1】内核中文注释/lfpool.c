@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2006-2022, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * 无锁固定块内存池
+ *
+ * 空闲块组成一个栈 栈顶用比较交换(CAS)修改 不关中断也不加锁 中断和线程都可以申请和释放
+ * 栈顶是一个32位字 低16位是块的序号(从1开始 0表示空) 高16位是标签
+ * 每次修改栈顶标签加1 避免ABA问题: 读出栈顶后 该块被取走又放回 此时序号相同但标签已变 CAS失败
+ * SMP下每个CPU有自己的空闲栈 释放放入当前CPU的栈 申请先取当前CPU的栈 取空后再从其他CPU的栈取
+ * 池中的块不会被归还给堆 取栈顶块中的next时即使该块刚被别人取走 读到的值也会因CAS失败被丢弃
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#ifdef RT_USING_LFPOOL
+
+#define LFPOOL_INDEX_MASK       0xffffU
+#define LFPOOL_TAG_ONE          0x10000U
+#define LFPOOL_BLOCK_MAX        0xffffU
+
+#ifdef RT_USING_SMP
+#define LFPOOL_CPU_NR           RT_CPUS_NR
+#define LFPOOL_CPU_ID()         rt_hw_cpu_id()
+#else
+#define LFPOOL_CPU_NR           1
+#define LFPOOL_CPU_ID()         0
+#endif /* RT_USING_SMP */
+
+/*
+ * 比较交换 *ptr等于expect时写入desired并返回RT_TRUE 否则把当前值读回expect并返回RT_FALSE
+ * GCC兼容的编译器使用内置原子操作 Cortex-M0等没有独占访问指令的内核用关中断模拟
+ */
+#if defined(__GNUC__) && !defined(ARCH_ARM_CORTEX_M0)
+#define LFPOOL_CAS(ptr, expect, desired) \
+    __atomic_compare_exchange_n((ptr), &(expect), (desired), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#else
+#ifdef RT_USING_SMP
+#error "lock-free pool needs atomic compare and swap on SMP"
+#endif /* RT_USING_SMP */
+static rt_bool_t _lfpool_cas(volatile rt_uint32_t *ptr, rt_uint32_t *expect, rt_uint32_t desired)
+{
+    rt_base_t level;
+    rt_bool_t result = RT_FALSE;
+
+    level = rt_hw_interrupt_disable();
+    if (*ptr == *expect)
+    {
+        *ptr = desired;
+        result = RT_TRUE;
+    }
+    else
+    {
+        *expect = *ptr;
+    }
+    rt_hw_interrupt_enable(level);
+
+    return result;
+}
+#define LFPOOL_CAS(ptr, expect, desired) _lfpool_cas((ptr), &(expect), (desired))
+#endif /* defined(__GNUC__) && !defined(ARCH_ARM_CORTEX_M0) */
+
+/**
+ * lock-free fixed-size block pool
+ */
+struct rt_lfpool
+{
+    rt_uint8_t                 *start;                  /**< beginning address of the blocks */
+    rt_size_t                   block_size;             /**< size of each block */
+    rt_uint32_t                 block_total;            /**< number of blocks */
+
+    volatile rt_uint32_t        head[LFPOOL_CPU_NR];    /**< free stack of each cpu, tag << 16 | index */
+};
+typedef struct rt_lfpool *rt_lfpool_t;
+
+/* 序号从1开始 */
+#define LFPOOL_BLOCK(pool, index)   ((pool)->start + ((index) - 1) * (pool)->block_size)
+#define LFPOOL_NEXT(block)          (*(volatile rt_uint32_t *)(block))
+
+/**
+ * @brief This function will initialize a lock-free block pool on a memory block.
+ *        All the blocks are put on the free stack of the first cpu.
+ *
+ * @param pool the pool to be initialized.
+ *
+ * @param start the beginning address of the memory block.
+ *
+ * @param size the size of the memory block.
+ *
+ * @param block_size the size of each block.
+ *
+ * @return the operation status, RT_EOK on successful, -RT_ERROR if the memory
+ *         block can't hold any block.
+ */
+rt_err_t rt_lfpool_init(struct rt_lfpool *pool, void *start, rt_size_t size, rt_size_t block_size)
+{
+    rt_uint32_t index;
+    rt_ubase_t begin;
+
+    RT_ASSERT(pool != RT_NULL);
+    RT_ASSERT(start != RT_NULL);
+
+    /* 块中至少要放下next */
+    block_size = RT_ALIGN(block_size, RT_ALIGN_SIZE);
+    if (block_size < sizeof(rt_uint32_t))
+        block_size = RT_ALIGN(sizeof(rt_uint32_t), RT_ALIGN_SIZE);
+
+    begin = RT_ALIGN((rt_ubase_t)start, RT_ALIGN_SIZE);
+    if ((rt_ubase_t)start + size < begin + block_size)
+        return -RT_ERROR;
+
+    rt_memset(pool, 0, sizeof(struct rt_lfpool));
+    pool->start       = (rt_uint8_t *)begin;
+    pool->block_size  = block_size;
+    pool->block_total = ((rt_ubase_t)start + size - begin) / block_size;
+    if (pool->block_total > LFPOOL_BLOCK_MAX)
+        pool->block_total = LFPOOL_BLOCK_MAX;
+
+    /* 按序号顺序串成空闲栈 */
+    for (index = 1; index < pool->block_total; index ++)
+        LFPOOL_NEXT(LFPOOL_BLOCK(pool, index)) = index + 1;
+    LFPOOL_NEXT(LFPOOL_BLOCK(pool, pool->block_total)) = 0;
+    pool->head[0] = 1;
+
+    return RT_EOK;
+}
+RTM_EXPORT(rt_lfpool_init);
+
+/* 从一个空闲栈中取出栈顶块 */
+static void *_lfpool_pop(struct rt_lfpool *pool, volatile rt_uint32_t *head)
+{
+    rt_uint32_t old, new_head;
+    rt_uint8_t *block;
+
+    old = *head;
+    do
+    {
+        if ((old & LFPOOL_INDEX_MASK) == 0)
+            return RT_NULL;
+
+        block = LFPOOL_BLOCK(pool, old & LFPOOL_INDEX_MASK);
+        /* 块可能已被别人取走 这时CAS会失败 读到的next不会被使用 */
+        new_head = ((old + LFPOOL_TAG_ONE) & ~LFPOOL_INDEX_MASK) | LFPOOL_NEXT(block);
+    } while (!LFPOOL_CAS(head, old, new_head));
+
+    return block;
+}
+
+/* 把块放到一个空闲栈的栈顶 */
+static void _lfpool_push(struct rt_lfpool *pool, volatile rt_uint32_t *head, rt_uint8_t *block)
+{
+    rt_uint32_t old, new_head, index;
+
+    index = (rt_uint32_t)((block - pool->start) / pool->block_size) + 1;
+
+    old = *head;
+    do
+    {
+        LFPOOL_NEXT(block) = old & LFPOOL_INDEX_MASK;
+        new_head = ((old + LFPOOL_TAG_ONE) & ~LFPOOL_INDEX_MASK) | index;
+    } while (!LFPOOL_CAS(head, old, new_head));
+}
+
+/**
+ * @brief This function will allocate a block from a lock-free pool.
+ *        It never blocks and never masks interrupts, so it can be invoked
+ *        in interrupt service routines.
+ *
+ * @param pool the pool.
+ *
+ * @return the allocated block, RT_NULL if the pool is empty.
+ */
+void *rt_lfpool_alloc(rt_lfpool_t pool)
+{
+    int cpu, index;
+    void *block;
+
+    RT_ASSERT(pool != RT_NULL);
+
+    /* 先取当前CPU的空闲栈 再依次取其他CPU的 */
+    cpu = LFPOOL_CPU_ID();
+    for (index = 0; index < LFPOOL_CPU_NR; index ++)
+    {
+        block = _lfpool_pop(pool, &pool->head[(cpu + index) % LFPOOL_CPU_NR]);
+        if (block != RT_NULL)
+            return block;
+    }
+
+    return RT_NULL;
+}
+RTM_EXPORT(rt_lfpool_alloc);
+
+/**
+ * @brief This function will release a block to a lock-free pool.
+ *        It can be invoked in interrupt service routines.
+ *
+ * @param pool the pool.
+ *
+ * @param block the block allocated by rt_lfpool_alloc.
+ */
+void rt_lfpool_free(rt_lfpool_t pool, void *block)
+{
+    RT_ASSERT(pool != RT_NULL);
+
+    if (block == RT_NULL)
+        return;
+
+    RT_ASSERT((rt_uint8_t *)block >= pool->start);
+    RT_ASSERT((rt_uint8_t *)block < pool->start + pool->block_total * pool->block_size);
+    RT_ASSERT(((rt_uint8_t *)block - pool->start) % pool->block_size == 0);
+
+    _lfpool_push(pool, &pool->head[LFPOOL_CPU_ID()], (rt_uint8_t *)block);
+}
+RTM_EXPORT(rt_lfpool_free);
+
+#endif /* RT_USING_LFPOOL */
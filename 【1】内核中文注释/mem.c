@@ -63,84 +63,1643 @@ struct rt_small_mem_item
     rt_size_t               next;             /**< next free item */
     /* һڴĵַƫ */
     rt_size_t               prev;             /**< prev free item */
+#ifdef RT_USING_SMALL_MEM_OWNER
+    /* ʹÿе± */
+    rt_uint16_t             owner;            /**< index in the owner table */
+#endif /* RT_USING_SMALL_MEM_OWNER */
 };
 
+#ifndef RT_SMALL_MEM_BIN_NR
+#define RT_SMALL_MEM_BIN_NR     16
+#endif
+
+/**
+ * free list node, only lives in the data area of a free item
+ */
+/* ڵ ֻڿп ʹõĿ鲻ռöռ */
+struct rt_small_mem_free_node
+{
+    /* ͬһߴȼһп */
+    struct rt_small_mem_item   *free_next;    /**< next free item in the same bin */
+    /* ͬһߴȼһп */
+    struct rt_small_mem_item   *free_prev;    /**< prev free item in the same bin */
+};
+
+#ifdef RT_USING_SMALL_MEM_MAGAZINE
+#ifndef RT_SMALL_MEM_MAGAZINE_CLASS_NR
+#define RT_SMALL_MEM_MAGAZINE_CLASS_NR  8
+#endif
+#ifndef RT_SMALL_MEM_MAGAZINE_SIZE
+#define RT_SMALL_MEM_MAGAZINE_SIZE      8
+#endif
+
+/**
+ * magazine of recently freed blocks of one size class on one cpu
+ */
+/* ÿCPUÿߴȼС黺 еĿڶԱΪʹ */
+struct rt_small_mem_magazine
+{
+    /* Ŀ */
+    rt_uint16_t                 count;
+    /* //黹 */
+    rt_uint32_t                 hit;
+    rt_uint32_t                 refill;
+    rt_uint32_t                 drain;
+    /* Ŀ(ַ) */
+    void                       *rounds[RT_SMALL_MEM_MAGAZINE_SIZE];
+};
+#endif /* RT_USING_SMALL_MEM_MAGAZINE */
+
+#ifdef RT_USING_SMALL_MEM_DEFER
+/* ӳͷ󳤶 ֱӺϲ */
+#ifndef RT_SMALL_MEM_DEFER_MAX
+#define RT_SMALL_MEM_DEFER_MAX          64
+#endif
+/* ߳ÿϲĿ */
+#ifndef RT_SMALL_MEM_DEFER_BUDGET
+#define RT_SMALL_MEM_DEFER_BUDGET       16
+#endif
+#endif /* RT_USING_SMALL_MEM_DEFER */
+
+#ifdef RT_USING_SMALL_MEM_OWNER
+#ifndef RT_SMALL_MEM_OWNER_NR
+#define RT_SMALL_MEM_OWNER_NR           16
+#endif
+/* 鲻κ: մӿȡ ڻӳͷ */
+#define SMEM_OWNER_NONE                 0xffff
+
+/* ֻڶ޸ ķͷŲж ʱж */
+#ifdef RT_USING_SMALL_MEM_MAGAZINE
+#define SMEM_OWNER_LOCK()               rt_hw_interrupt_disable()
+#define SMEM_OWNER_UNLOCK(level)        rt_hw_interrupt_enable(level)
+#else
+#define SMEM_OWNER_LOCK()               0
+#define SMEM_OWNER_UNLOCK(level)        ((void)(level))
+#endif /* RT_USING_SMALL_MEM_MAGAZINE */
+
+/**
+ * memory usage of one owner, a thread or a tag
+ */
+/*  0¼ж ׶Լʱķ */
+struct rt_smem_owner
+{
+    const void                 *key;                    /**< thread or tag, RT_NULL if unused */
+    char                        name[RT_NAME_MAX];      /**< name of the thread or the tag */
+    rt_size_t                   bytes;                  /**< bytes of the blocks owned */
+    rt_size_t                   blocks;                 /**< number of the blocks owned */
+    rt_size_t                   max;                    /**< maximum of bytes */
+};
+#endif /* RT_USING_SMALL_MEM_OWNER */
+
+#ifdef RT_USING_SMALL_MEM_GUARD
+/* ۵ĸ */
+#ifndef RT_SMALL_MEM_GUARD_SLOT_NR
+#define RT_SMALL_MEM_GUARD_SLOT_NR      8
+#endif
+/* ɵֽ 벻ᱻ */
+#ifndef RT_SMALL_MEM_GUARD_SLOT_SIZE
+#define RT_SMALL_MEM_GUARD_SLOT_SIZE    256
+#endif
+/* Сֽ */
+#ifndef RT_SMALL_MEM_GUARD_REDZONE
+#define RT_SMALL_MEM_GUARD_REDZONE      16
+#endif
+/* ƽÿٴηȡһη뱣 */
+#ifndef RT_SMALL_MEM_GUARD_RATE
+#define RT_SMALL_MEM_GUARD_RATE         1000
+#endif
+/* ߳ÿμĲ */
+#ifndef RT_SMALL_MEM_GUARD_BUDGET
+#define RT_SMALL_MEM_GUARD_BUDGET       2
+#endif
+
+/* ⵽Ĵ */
+#define RT_SMEM_GUARD_OVERFLOW          1       /**< red zone of a used slot is overwritten */
+#define RT_SMEM_GUARD_USE_AFTER_FREE    2       /**< released slot is overwritten */
+#define RT_SMEM_GUARD_DOUBLE_FREE       3       /**< released slot is released again */
+#define RT_SMEM_GUARD_INVALID_FREE      4       /**< pointer in a slot but not the block */
+
+/**
+ * one guarded slot, the bookkeeping lives outside the slot memory
+ */
+/*  ֻݺͺ ۵ϢⱣ ᱻԽд */
+struct rt_smem_guard_slot
+{
+    rt_uint8_t                 *data;                   /**< data area of the block */
+    rt_uint16_t                 size;                   /**< requested size */
+    rt_uint8_t                  used;                   /**< RT_TRUE if the block is in use */
+    rt_uint32_t                 free_seq;               /**< release order, the oldest is reused first */
+    char                        alloc_name[RT_NAME_MAX];/**< thread allocating the block */
+    char                        free_name[RT_NAME_MAX]; /**< thread releasing the block */
+};
+#endif /* RT_USING_SMALL_MEM_GUARD */
+
+#ifdef RT_USING_SMALL_MEM_TRACE
+/* ¼Ĳ */
+#define RT_SMEM_TRACE_ALLOC         1
+#define RT_SMEM_TRACE_REALLOC       2
+#define RT_SMEM_TRACE_FREE          3
+#define RT_SMEM_TRACE_ALLOC_ALIGN   4
+
+/**
+ * one allocation trace record
+ *
+ * handle and result are offsets of the data area from the heap begin, 0 for RT_NULL.
+ * For RT_SMEM_TRACE_ALLOC_ALIGN, handle holds the alignment.
+ */
+/* 켣¼ ÿ16ֽ */
+struct rt_smem_trace_record
+{
+    rt_uint32_t                 timestamp;              /**< time of the operation */
+    rt_uint32_t                 op_size;                /**< op in bit 31..24, size in bit 23..0 */
+    rt_uint32_t                 handle;                 /**< block passed in */
+    rt_uint32_t                 result;                 /**< block returned */
+};
+#endif /* RT_USING_SMALL_MEM_TRACE */
+
+/**
+ * Base structure of small memory object
+ */
+/* ڴϢ */
+struct rt_small_mem
+{
+    /* ̳rt_memory */
+    struct rt_memory            parent;                 /**< inherit from rt_memory */
+    /* ڴѵʼַ */
+    rt_uint8_t                 *heap_ptr;               /**< pointer to the heap */
+    /* ڴѽβͷַ */
+    struct rt_small_mem_item   *heap_end;
+    /* ߴȼֵĿ */
+    struct rt_small_mem_item   *free_bins[RT_SMALL_MEM_BIN_NR]; /**< segregated free lists */
+    /* ǿտλͼ */
+    rt_uint32_t                 free_bitmap;            /**< bitmap of non-empty bins */
+    /* ķָ/ϲ ڼжѽṹǷ仯 */
+    rt_uint32_t                 version;                /**< changed on every split and merge */
+    /* ڴ */
+    rt_size_t                   mem_size_aligned;       /**< aligned memory size */
+    /* ԭɵrealloc */
+    rt_uint32_t                 realloc_inplace;        /**< realloc without moving data */
+    /* Ҫ¿鲢ݵrealloc */
+    rt_uint32_t                 realloc_moved;          /**< realloc with allocate-copy-free */
+#ifdef RT_USING_SMALL_MEM_MAGAZINE
+    /* ÿCPUС黺 */
+    struct rt_small_mem_magazine magazine[RT_CPUS_NR][RT_SMALL_MEM_MAGAZINE_CLASS_NR];
+#endif /* RT_USING_SMALL_MEM_MAGAZINE */
+#ifdef RT_USING_SMALL_MEM_DEFER
+    /* ȴϲĿ ڶԱΪʹ ͨеfree_next */
+    struct rt_small_mem_item   *defer_list;
+    rt_uint32_t                 defer_count;            /**< blocks waiting for coalescing */
+    rt_uint32_t                 defer_max;              /**< maximum of defer_count */
+    rt_uint32_t                 defer_retry;            /**< allocations retried after coalescing */
+#endif /* RT_USING_SMALL_MEM_DEFER */
+#ifdef RT_USING_SMALL_MEM_OWNER
+    /*  */
+    struct rt_smem_owner        owner[RT_SMALL_MEM_OWNER_NR];
+    /* ϴе ͬһ߳ʱò */
+    rt_uint16_t                 owner_last;
+#endif /* RT_USING_SMALL_MEM_OWNER */
+#ifdef RT_USING_SMALL_MEM_GUARD
+    /* ڵڴ ʼʱӱз ΪRT_NULLʱ */
+    rt_uint8_t                 *guard_area;
+    struct rt_small_mem        *guard_next;             /**< next heap having guard slots */
+    struct rt_smem_guard_slot   guard_slot[RT_SMALL_MEM_GUARD_SLOT_NR];
+    rt_uint32_t                 guard_rate;             /**< sampling rate, 0 if disabled */
+    rt_uint32_t                 guard_countdown;        /**< allocations before next sample */
+    rt_uint32_t                 guard_seed;             /**< random seed of the sampling interval */
+    rt_uint32_t                 guard_seq;              /**< counter of releases */
+    rt_uint16_t                 guard_check;            /**< next slot checked in idle */
+    rt_uint32_t                 guard_sampled;          /**< blocks placed in slots */
+    rt_uint32_t                 guard_errors;           /**< errors detected */
+#endif /* RT_USING_SMALL_MEM_GUARD */
+    /* ѵrt_smem_alloc/rt_smem_freeӵ rt_smem_set_lock */
+    rt_object_t                 lock;                   /**< mutex or semaphore of the owner */
+#ifdef RT_USING_SMALL_MEM_TRACE
+    /* 켣¼Ļλ ΪRT_NULLʱ¼ */
+    struct rt_smem_trace_record *trace_buf;
+    rt_uint32_t                 trace_size;             /**< capacity in records */
+    rt_uint32_t                 trace_head;             /**< records written */
+    rt_uint32_t                 trace_tail;             /**< records read */
+    rt_uint32_t                 trace_lost;             /**< records dropped while full */
+#endif /* RT_USING_SMALL_MEM_TRACE */
+};
+
+/**
+ * iterator of the blocks in a small memory object
+ */
+/* ѱ */
+struct rt_smem_walker
+{
+    /* һҪʵĿƫ */
+    rt_size_t                   offset;
+    /* һʱѵversion */
+    rt_uint32_t                 version;
+};
+
+/**
+ * one block reported by rt_smem_walk
+ */
+/* õĿϢ */
+struct rt_smem_block
+{
+    void                       *addr;                   /**< address of the data area */
+    rt_size_t                   size;                   /**< size of the data area */
+    rt_bool_t                   used;                   /**< RT_TRUE if the block is used */
+};
+
+/**
+ * fragmentation summary, computed by rt_smem_stat_step in bounded steps
+ */
+/* Ƭͳ ֶ */
+struct rt_smem_stat
+{
+    struct rt_smem_walker       walker;
+    rt_size_t                   free_total;             /**< total free bytes */
+    rt_size_t                   free_blocks;            /**< number of free blocks */
+    rt_size_t                   largest_free;           /**< largest free block */
+    rt_size_t                   used_blocks;            /**< number of used blocks */
+    rt_size_t                   free_hist[RT_SMALL_MEM_BIN_NR]; /**< free blocks per size class */
+    rt_size_t                   used_hist[RT_SMALL_MEM_BIN_NR]; /**< used blocks per size class */
+    rt_uint8_t                  frag_index;             /**< 0 (none) .. 100 (fully fragmented) */
+    rt_uint16_t                 restart;                /**< times the walk restarted as the heap changed */
+};
+
+#define HEAP_MAGIC 0x1ea0
+/* Сֽ */
+#define MIN_SIZE 12
+
+#define MEM_MASK             0xfffffffe
+#define MEM_USED()         ((((rt_base_t)(small_mem)) & MEM_MASK) | 0x1)
+#define MEM_FREED()        ((((rt_base_t)(small_mem)) & MEM_MASK) | 0x0)
+#define MEM_ISUSED(_mem)   \
+                      (((rt_base_t)(((struct rt_small_mem_item *)(_mem))->pool_ptr)) & (~MEM_MASK))
+#define MEM_POOL(_mem)     \
+    ((struct rt_small_mem *)(((rt_base_t)(((struct rt_small_mem_item *)(_mem))->pool_ptr)) & (MEM_MASK)))
+#define MEM_SIZE(_heap, _mem)      \
+    (((struct rt_small_mem_item *)(_mem))->next - ((rt_ubase_t)(_mem) - \
+    (rt_ubase_t)((_heap)->heap_ptr)) - RT_ALIGN(sizeof(struct rt_small_mem_item), RT_ALIGN_SIZE))
+/* СĴ4ֽڵĶ */
+#define MIN_SIZE_ALIGNED     RT_ALIGN(MIN_SIZE, RT_ALIGN_SIZE)
+#define SIZEOF_STRUCT_MEM    RT_ALIGN(sizeof(struct rt_small_mem_item), RT_ALIGN_SIZE)
+/* пҪܷ¿ڵ */
+#define MIN_SIZE_FREE        RT_ALIGN(sizeof(struct rt_small_mem_free_node), RT_ALIGN_SIZE)
+#define MIN_BLOCK_SIZE       (MIN_SIZE_ALIGNED > MIN_SIZE_FREE ? MIN_SIZE_ALIGNED : MIN_SIZE_FREE)
+/* пеĿڵ */
+#define MEM_FREE_NODE(_mem)  \
+    ((struct rt_small_mem_free_node *)((rt_uint8_t *)(_mem) + SIZEOF_STRUCT_MEM))
+
+/* ߴȼ: 0Ϊ[0, 32) ֮ÿ һиĿ */
+#define SMEM_BIN_SHIFT       4
+
+#if RT_SMALL_MEM_BIN_NR > 32
+#error "RT_SMALL_MEM_BIN_NR must not be greater than 32"
+#endif
+
+/* Сߴȼ */
+rt_inline rt_uint32_t _smem_bin_index(rt_size_t size)
+{
+    rt_uint32_t index = 0;
+
+    size >>= SMEM_BIN_SHIFT;
+    while (size > 1 && index < RT_SMALL_MEM_BIN_NR - 1)
+    {
+        size >>= 1;
+        index ++;
+    }
+
+    return index;
+}
+
+#if defined(RT_USING_SMALL_MEM_DEFER) || defined(RT_USING_SMALL_MEM_GUARD) || defined(RT_USING_FINSH)
+/*
+ * ȡöѵע ̲ܹ߳ ֻtimeoutΪ0ķʽ
+ * ûעĶΪֻڵʱʹ ǰҪ
+ */
+static rt_err_t _smem_lock(struct rt_small_mem *small_mem, rt_int32_t timeout)
+{
+    rt_object_t lock = small_mem->lock;
+
+    if (lock == RT_NULL)
+    {
+        rt_enter_critical();
+        return RT_EOK;
+    }
+    if (rt_thread_self() == RT_NULL)
+        return RT_EOK;
+
+#ifdef RT_USING_MUTEX
+    if (rt_object_get_type(lock) == RT_Object_Class_Mutex)
+        return rt_mutex_take((rt_mutex_t)lock, timeout);
+#endif /* RT_USING_MUTEX */
+
+    return rt_sem_take((rt_sem_t)lock, timeout);
+}
+
+static void _smem_unlock(struct rt_small_mem *small_mem)
+{
+    rt_object_t lock = small_mem->lock;
+
+    if (lock == RT_NULL)
+    {
+        rt_exit_critical();
+        return;
+    }
+    if (rt_thread_self() == RT_NULL)
+        return;
+
+#ifdef RT_USING_MUTEX
+    if (rt_object_get_type(lock) == RT_Object_Class_Mutex)
+    {
+        rt_mutex_release((rt_mutex_t)lock);
+        return;
+    }
+#endif /* RT_USING_MUTEX */
+
+    rt_sem_release((rt_sem_t)lock);
+}
+#endif /* defined(RT_USING_SMALL_MEM_DEFER) || defined(RT_USING_SMALL_MEM_GUARD) || defined(RT_USING_FINSH) */
+
+/* пӦߴȼĿͷ */
+static void _smem_free_insert(struct rt_small_mem *m, struct rt_small_mem_item *mem)
+{
+    rt_uint32_t index;
+    struct rt_small_mem_free_node *node;
+
+    RT_ASSERT(!MEM_ISUSED(mem));
+
+    index = _smem_bin_index(MEM_SIZE(m, mem));
+    node  = MEM_FREE_NODE(mem);
+
+    node->free_prev = RT_NULL;
+    node->free_next = m->free_bins[index];
+    if (node->free_next != RT_NULL)
+    {
+        MEM_FREE_NODE(node->free_next)->free_prev = mem;
+    }
+    m->free_bins[index] = mem;
+    m->free_bitmap |= 1ul << index;
+    /* µĿп鶼Էָϲ ѽṹ˱仯 */
+    m->version ++;
+}
+
+/* пڵĿƳ ޸ĿС֮ǰ */
+static void _smem_free_remove(struct rt_small_mem *m, struct rt_small_mem_item *mem)
+{
+    rt_uint32_t index;
+    struct rt_small_mem_free_node *node;
+
+    index = _smem_bin_index(MEM_SIZE(m, mem));
+    node  = MEM_FREE_NODE(mem);
+
+    if (node->free_prev != RT_NULL)
+    {
+        MEM_FREE_NODE(node->free_prev)->free_next = node->free_next;
+    }
+    else
+    {
+        RT_ASSERT(m->free_bins[index] == mem);
+        m->free_bins[index] = node->free_next;
+        if (m->free_bins[index] == RT_NULL)
+        {
+            m->free_bitmap &= ~(1ul << index);
+        }
+    }
+
+    if (node->free_next != RT_NULL)
+    {
+        MEM_FREE_NODE(node->free_next)->free_prev = node->free_prev;
+    }
+}
+
+/* һСsizeĿп ҲRT_NULL */
+static struct rt_small_mem_item *_smem_free_find(struct rt_small_mem *m, rt_size_t size)
+{
+    rt_uint32_t index, bitmap;
+    struct rt_small_mem_item *mem;
+
+    index = _smem_bin_index(size);
+
+    /* ͬһȼеĿСһ ҪȽ */
+    for (mem = m->free_bins[index]; mem != RT_NULL; mem = MEM_FREE_NODE(mem)->free_next)
+    {
+        if (MEM_SIZE(m, mem) >= size)
+            return mem;
+    }
+
+    /* ߵȼеһ鶼Ҫ ֱȡͷ */
+    if (index + 1 >= RT_SMALL_MEM_BIN_NR)
+        return RT_NULL;
+
+    bitmap = m->free_bitmap & ~((2ul << index) - 1);
+    if (bitmap == 0)
+        return RT_NULL;
+
+    return m->free_bins[__rt_ffs(bitmap) - 1];
+}
+
+/* ڴͷʱڵϲ 
+ * memʱΪпҲκο ϲĿᱻ */
+static void plug_holes(struct rt_small_mem *m, struct rt_small_mem_item *mem)
+{
+    struct rt_small_mem_item *nmem; /* һСڴĽڵϢ  */
+    struct rt_small_mem_item *pmem; /* һСڴĽڵϢ  */
+
+    RT_ASSERT((rt_uint8_t *)mem >= m->heap_ptr);
+    RT_ASSERT((rt_uint8_t *)mem < (rt_uint8_t *)m->heap_end);
+
+    /* plug hole forward */
+    nmem = (struct rt_small_mem_item *)&m->heap_ptr[mem->next];/* ȡǰڴһڴĵַ */
+    if (mem != nmem && !MEM_ISUSED(nmem) &&
+        (rt_uint8_t *)nmem != (rt_uint8_t *)m->heap_end)
+    {
+        /* if mem->next is unused and not end of m->heap_ptr,
+         * combine mem and mem->next
+         */
+        /* һϲǰȴӿȡ */
+        _smem_free_remove(m, nmem);
+        nmem->pool_ptr = 0;
+        mem->next = nmem->next;
+        ((struct rt_small_mem_item *)&m->heap_ptr[nmem->next])->prev = (rt_uint8_t *)mem - m->heap_ptr;
+    }
+
+    /* plug hole backward */
+    pmem = (struct rt_small_mem_item *)&m->heap_ptr[mem->prev];
+    if (pmem != mem && !MEM_ISUSED(pmem))
+    {
+        /* if mem->prev is unused, combine mem and mem->prev */
+        /* ǰһĴС仯 Ҫȴӿȡ */
+        _smem_free_remove(m, pmem);
+        mem->pool_ptr = 0;
+        pmem->next = mem->next;
+        ((struct rt_small_mem_item *)&m->heap_ptr[mem->next])->prev = (rt_uint8_t *)pmem - m->heap_ptr;
+        mem = pmem;
+    }
+
+    /* ϲĿһؿ */
+    _smem_free_insert(m, mem);
+}
+
+#ifdef RT_USING_SMALL_MEM_DEFER
+static void _smem_free_block(struct rt_small_mem *small_mem, struct rt_small_mem_item *mem);
+
+/* ϲӳͷŵĿ budgetΪ0ʱȫϲ ʣĿ */
+static rt_uint32_t _smem_defer_merge(struct rt_small_mem *small_mem, rt_uint32_t budget)
+{
+    rt_base_t level;
+    struct rt_small_mem_item *mem;
+
+    do
+    {
+        /* ÿ鵥ж ⳤʱж */
+        level = rt_hw_interrupt_disable();
+        mem = small_mem->defer_list;
+        if (mem == RT_NULL)
+        {
+            rt_hw_interrupt_enable(level);
+            break;
+        }
+        small_mem->defer_list = MEM_FREE_NODE(mem)->free_next;
+        small_mem->defer_count --;
+        _smem_free_block(small_mem, mem);
+        rt_hw_interrupt_enable(level);
+    } while (budget == 0 || -- budget > 0);
+
+    return small_mem->defer_count;
+}
+#endif /* RT_USING_SMALL_MEM_DEFER */
+
+/* ӿзһΪsizeֽڵĿ sizeѰRT_ALIGN_SIZE */
+static void *_smem_use_block(struct rt_small_mem *small_mem, struct rt_small_mem_item *mem, rt_size_t size);
+
+static void *_smem_alloc_block(struct rt_small_mem *small_mem, rt_size_t size)
+{
+    struct rt_small_mem_item *mem;
+
+    /* ÿݿĳȱΪMIN_BLOCK_SIZE Ĭ12ֽ ͷźҪܷ¿ڵ */
+    if (size < MIN_BLOCK_SIZE)
+        size = MIN_BLOCK_SIZE;
+    /* жڴĴС Ƿ񳬹 mem_size_alignedΪɹ  */
+    if (size > small_mem->mem_size_aligned)
+    {
+        RT_DEBUG_LOG(RT_DEBUG_MEM, ("no memory\n"));
+
+        return RT_NULL;
+    }
+    /*
+     * δ ɹ
+     * ӳߴȼӦĿв ֻʿп ٱʹõĿ */
+    mem = _smem_free_find(small_mem, size);
+#ifdef RT_USING_SMALL_MEM_DEFER
+    /* ϲӳͷŵĿһ */
+    if (mem == RT_NULL && small_mem->defer_list != RT_NULL)
+    {
+        _smem_defer_merge(small_mem, 0);
+        small_mem->defer_retry ++;
+        mem = _smem_free_find(small_mem, size);
+    }
+#endif /* RT_USING_SMALL_MEM_DEFER */
+    if (mem == RT_NULL)
+    {
+        RT_DEBUG_LOG(RT_DEBUG_MEM, ("no memory\n"));
+
+        return RT_NULL;
+    }
+    /* ȴӿȡ */
+    _smem_free_remove(small_mem, mem);
+
+    return _smem_use_block(small_mem, mem, size);
+}
+
+/* һѴӿȡµĿпΪʹ Ĳֲֺһؿ */
+static void *_smem_use_block(struct rt_small_mem *small_mem, struct rt_small_mem_item *mem, rt_size_t size)
+{
+    rt_size_t ptr, ptr2;
+    struct rt_small_mem_item *mem2;
+
+    ptr = (rt_uint8_t *)mem - small_mem->heap_ptr;
+
+    /* ǰitemڴҪĿռϢĿռĶ  */
+    if (mem->next - (ptr + SIZEOF_STRUCT_MEM) >= (size + SIZEOF_STRUCT_MEM + MIN_BLOCK_SIZE))
+    {
+        /* ָ */
+        /*ptr2 ָǰϢʵڴģһпҪдӦϢ飩*/
+        ptr2 = ptr + SIZEOF_STRUCT_MEM + size;
+        /* ղŵڴ鱻ʹ һڴ mem2 */
+        mem2       = (struct rt_small_mem_item *)&small_mem->heap_ptr[ptr2];
+        /* ״̬Ϊ */
+        mem2->pool_ptr = MEM_FREED();
+        /* mem2ָһڴ ָ֮ǰmemָڴ */
+        mem2->next = mem->next;
+        /* ǰһַָ ֮ǰڴ*/
+        mem2->prev = ptr;
+
+        /* mem֮ǰָmem->next ָptr2 */
+        mem->next = ptr2;
+        /* */
+        if (mem2->next != small_mem->mem_size_aligned + SIZEOF_STRUCT_MEM)
+        {
+            ((struct rt_small_mem_item *)&small_mem->heap_ptr[mem2->next])->prev = ptr2;
+        }
+        /* ʣಿֹһؿ пѺϲ mem2һʹõĿ */
+        _smem_free_insert(small_mem, mem2);
+        /* ¼ʹõڴС  */
+        small_mem->parent.used += (size + SIZEOF_STRUCT_MEM);
+        if (small_mem->parent.max < small_mem->parent.used)
+            small_mem->parent.max = small_mem->parent.used;
+    }
+    else
+    {
+        /* ָ ֱӷ*/
+        small_mem->parent.used += mem->next - ((rt_uint8_t *)mem - small_mem->heap_ptr);
+        if (small_mem->parent.max < small_mem->parent.used)
+            small_mem->parent.max = small_mem->parent.used;
+    }
+    /* ֮ǰĿڴѱʹ */
+    mem->pool_ptr = MEM_USED();
+#ifdef RT_USING_SMALL_MEM_OWNER
+    mem->owner = SMEM_OWNER_NONE;
+#endif /* RT_USING_SMALL_MEM_OWNER */
+
+    RT_ASSERT((rt_ubase_t)mem + SIZEOF_STRUCT_MEM + size <= (rt_ubase_t)small_mem->heap_end);
+    RT_ASSERT((rt_ubase_t)((rt_uint8_t *)mem + SIZEOF_STRUCT_MEM) % RT_ALIGN_SIZE == 0);
+    RT_ASSERT((((rt_ubase_t)mem) & (RT_ALIGN_SIZE - 1)) == 0);
+
+    RT_DEBUG_LOG(RT_DEBUG_MEM,
+                 ("allocate memory at 0x%x, size: %d\n",
+                  (rt_ubase_t)((rt_uint8_t *)mem + SIZEOF_STRUCT_MEM),
+                  (rt_ubase_t)(mem->next - ((rt_uint8_t *)mem - small_mem->heap_ptr))));
+
+    /* سmemṹ֮ڴ */
+    return (rt_uint8_t *)mem + SIZEOF_STRUCT_MEM;
+}
+
+/* ͷһʹõĿ ڵĿпϲ */
+static void _smem_free_block(struct rt_small_mem *small_mem, struct rt_small_mem_item *mem)
+{
+    /* ... and is now unused. */
+    mem->pool_ptr = MEM_FREED();
+
+    small_mem->parent.used -= (mem->next - ((rt_uint8_t *)mem - small_mem->heap_ptr));
+
+    /* finally, see if prev or next are free also */
+    /* ڵĿпϲ ӦĿ */
+    plug_holes(small_mem, mem);
+}
+
+/* ʹõĿضΪnewsize β㹻ʱΪп黹 */
+static void _smem_shrink_block(struct rt_small_mem *small_mem, struct rt_small_mem_item *mem, rt_size_t newsize)
+{
+    rt_size_t ptr, ptr2, size;
+    struct rt_small_mem_item *mem2;
+
+    ptr = (rt_uint8_t *)mem - small_mem->heap_ptr;
+    size = mem->next - ptr - SIZEOF_STRUCT_MEM;
+    if (newsize + SIZEOF_STRUCT_MEM + MIN_BLOCK_SIZE >= size)
+        return;
+
+    /* split memory block */
+    small_mem->parent.used -= (size - newsize);
+
+    ptr2 = ptr + SIZEOF_STRUCT_MEM + newsize;
+    mem2 = (struct rt_small_mem_item *)&small_mem->heap_ptr[ptr2];
+    mem2->pool_ptr = MEM_FREED();
+    mem2->next = mem->next;
+    mem2->prev = ptr;
+    mem->next = ptr2;
+    if (mem2->next != small_mem->mem_size_aligned + SIZEOF_STRUCT_MEM)
+    {
+        ((struct rt_small_mem_item *)&small_mem->heap_ptr[mem2->next])->prev = ptr2;
+    }
+
+    /* Ŀпϲ */
+    plug_holes(small_mem, mem2);
+}
+
+#ifdef RT_USING_SMALL_MEM_TRACE
+#define SMEM_TRACE_SIZE_MASK 0x00fffffful
+
+/* ַתΪԶʼַƫ ֮ͬԱȽ */
+#define SMEM_TRACE_HANDLE(_heap, _ptr)  \
+    ((_ptr) ? (rt_uint32_t)((rt_uint8_t *)(_ptr) - (_heap)->heap_ptr) : 0)
+
+#ifdef RT_USING_CLOCK_MONOTONIC
+/* еʱʱĬ΢ʱ ¼ֻ32λ Լ71ӻһ ¼ʱ32λ޷ */
+static rt_tick_t _smem_trace_timestamp_us(void)
+{
+    return (rt_tick_t)(rt_clock_monotonic_ns() / 1000);
+}
+#define SMEM_TRACE_TIMESTAMP    _smem_trace_timestamp_us
+#else
+#define SMEM_TRACE_TIMESTAMP    rt_tick_get
+#endif /* RT_USING_CLOCK_MONOTONIC */
+
+static rt_tick_t (*_smem_trace_timestamp)(void) = SMEM_TRACE_TIMESTAMP;
+
+/**
+ * @brief This function will set the timestamp source of the allocation trace. A
+ *        free running hardware counter gives a much finer resolution than the tick.
+ *
+ * @param get the function returning the timestamp, RT_NULL to use the default
+ *        one, which is the monotonic clock in us with RT_USING_CLOCK_MONOTONIC,
+ *        or rt_tick_get. The timestamp is kept in 32 bits, the us one wraps
+ *        around about every 71.6 minutes, so the time between two records
+ *        shall be computed modulo 2^32.
+ */
+void rt_smem_trace_set_timestamp(rt_tick_t (*get)(void))
+{
+    _smem_trace_timestamp = get ? get : SMEM_TRACE_TIMESTAMP;
+}
+RTM_EXPORT(rt_smem_trace_set_timestamp);
+
+/* ׷һ¼ ʱ ֤Ѽ¼Ĳ */
+static void _smem_trace(struct rt_small_mem *small_mem, rt_uint32_t op, rt_size_t size,
+                        rt_uint32_t handle, rt_uint32_t result)
+{
+    rt_base_t level;
+    struct rt_smem_trace_record *record;
+
+    if (small_mem->trace_buf == RT_NULL)
+        return;
+
+    level = rt_hw_interrupt_disable();
+    if (small_mem->trace_buf != RT_NULL)
+    {
+        if (small_mem->trace_head - small_mem->trace_tail < small_mem->trace_size)
+        {
+            record = &small_mem->trace_buf[small_mem->trace_head % small_mem->trace_size];
+            record->timestamp = _smem_trace_timestamp();
+            record->op_size   = (op << 24) | (size > SMEM_TRACE_SIZE_MASK ? SMEM_TRACE_SIZE_MASK : size);
+            record->handle    = handle;
+            record->result    = result;
+            small_mem->trace_head ++;
+        }
+        else
+        {
+            small_mem->trace_lost ++;
+        }
+    }
+    rt_hw_interrupt_enable(level);
+}
+
+#define SMEM_TRACE(_heap, _op, _size, _handle, _result) \
+    _smem_trace(_heap, _op, _size, _handle, _result)
+
+/**
+ * @brief This function will start recording the allocation trace of a heap into
+ *        a ring buffer. Records are taken out by rt_smem_trace_read.
+ *
+ * @param m the small memory management object.
+ *
+ * @param buffer the buffer to hold the records.
+ *
+ * @param size the size of buffer in bytes.
+ *
+ * @return RT_EOK on success, -RT_EINVAL if the buffer can not hold one record.
+ */
+rt_err_t rt_smem_trace_start(rt_smem_t m, void *buffer, rt_size_t size)
+{
+    rt_base_t level;
+    struct rt_small_mem *small_mem;
+
+    RT_ASSERT(m != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&m->parent) == RT_Object_Class_Memory);
+
+    if (buffer == RT_NULL || size < sizeof(struct rt_smem_trace_record))
+        return -RT_EINVAL;
+
+    small_mem = (struct rt_small_mem *)m;
+
+    level = rt_hw_interrupt_disable();
+    small_mem->trace_size = size / sizeof(struct rt_smem_trace_record);
+    small_mem->trace_head = 0;
+    small_mem->trace_tail = 0;
+    small_mem->trace_lost = 0;
+    small_mem->trace_buf  = (struct rt_smem_trace_record *)buffer;
+    rt_hw_interrupt_enable(level);
+
+    return RT_EOK;
+}
+RTM_EXPORT(rt_smem_trace_start);
+
+/**
+ * @brief This function will stop recording the allocation trace. The records not
+ *        read yet are dropped, and the buffer can be released after this call.
+ *
+ * @param m the small memory management object.
+ *
+ * @return the number of records dropped because the buffer was full.
+ */
+rt_uint32_t rt_smem_trace_stop(rt_smem_t m)
+{
+    rt_base_t level;
+    rt_uint32_t lost;
+    struct rt_small_mem *small_mem;
+
+    RT_ASSERT(m != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&m->parent) == RT_Object_Class_Memory);
+
+    small_mem = (struct rt_small_mem *)m;
+
+    level = rt_hw_interrupt_disable();
+    small_mem->trace_buf = RT_NULL;
+    lost = small_mem->trace_lost;
+    rt_hw_interrupt_enable(level);
+
+    return lost;
+}
+RTM_EXPORT(rt_smem_trace_stop);
+
+/**
+ * @brief This function will take the recorded allocation trace out of the ring
+ *        buffer, so that a thread can stream it to a device or a file.
+ *
+ * @param m the small memory management object.
+ *
+ * @param records the buffer to store the records.
+ *
+ * @param count the maximum number of records to read.
+ *
+ * @return the number of records read.
+ */
+rt_size_t rt_smem_trace_read(rt_smem_t m, struct rt_smem_trace_record *records, rt_size_t count)
+{
+    rt_size_t index;
+    rt_base_t level;
+    struct rt_small_mem *small_mem;
+
+    RT_ASSERT(m != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&m->parent) == RT_Object_Class_Memory);
+    RT_ASSERT(records != RT_NULL);
+
+    small_mem = (struct rt_small_mem *)m;
+
+    level = rt_hw_interrupt_disable();
+    for (index = 0; index < count; index ++)
+    {
+        if (small_mem->trace_buf == RT_NULL || small_mem->trace_tail == small_mem->trace_head)
+            break;
+        records[index] = small_mem->trace_buf[small_mem->trace_tail % small_mem->trace_size];
+        small_mem->trace_tail ++;
+    }
+    rt_hw_interrupt_enable(level);
+
+    return index;
+}
+RTM_EXPORT(rt_smem_trace_read);
+#else
+#define SMEM_TRACE(_heap, _op, _size, _handle, _result)
+#endif /* RT_USING_SMALL_MEM_TRACE */
+
+#ifdef RT_USING_SMALL_MEM_OWNER
+/* һǼ ± ʱ0
+ * Ӽɢλÿʼ ֻỻɱļᱻ δʹõıֹͣ */
+static rt_uint16_t _smem_owner_index(struct rt_small_mem *small_mem, const void *key, const char *name)
+{
+    rt_uint16_t index, count, slot = 0;
+    struct rt_smem_owner *owner;
+
+    if (key == RT_NULL)
+        return 0;
+    if (small_mem->owner[small_mem->owner_last].key == key)
+        return small_mem->owner_last;
+
+    index = ((rt_ubase_t)key >> 3) % (RT_SMALL_MEM_OWNER_NR - 1) + 1;
+    for (count = 1; count < RT_SMALL_MEM_OWNER_NR; count ++)
+    {
+        owner = &small_mem->owner[index];
+        if (owner->key == key)
+        {
+            small_mem->owner_last = index;
+            return index;
+        }
+        /* ûпıøµ */
+        if (slot == 0 && owner->blocks == 0)
+            slot = index;
+        if (owner->key == RT_NULL)
+            break;
+
+        index = (index == RT_SMALL_MEM_OWNER_NR - 1) ? 1 : index + 1;
+    }
+
+    if (slot != 0)
+    {
+        owner = &small_mem->owner[slot];
+        owner->key   = key;
+        rt_strncpy(owner->name, name, RT_NAME_MAX);
+        owner->bytes = 0;
+        owner->max   = 0;
+        small_mem->owner_last = slot;
+    }
+
+    return slot;
+}
+
+/* ǵ SMEM_OWNER_LOCKе */
+rt_inline void _smem_owner_add(struct rt_small_mem *small_mem, struct rt_small_mem_item *mem, rt_uint16_t index)
+{
+    struct rt_smem_owner *owner = &small_mem->owner[index];
+
+    mem->owner = index;
+    owner->bytes += MEM_SIZE(small_mem, mem);
+    owner->blocks ++;
+    if (owner->bytes > owner->max)
+        owner->max = owner->bytes;
+}
+
+/* ȥ SMEM_OWNER_LOCKе */
+rt_inline void _smem_owner_sub(struct rt_small_mem *small_mem, struct rt_small_mem_item *mem)
+{
+    struct rt_smem_owner *owner = &small_mem->owner[mem->owner];
+
+    RT_ASSERT(mem->owner != SMEM_OWNER_NONE);
+    owner->bytes -= MEM_SIZE(small_mem, mem);
+    owner->blocks --;
+    mem->owner = SMEM_OWNER_NONE;
+}
+
+/* ·Ŀǵtag tagΪRT_NULLʱǵǰ߳ */
+static void _smem_owner_take(struct rt_small_mem *small_mem, void *rmem, const char *tag)
+{
+    rt_base_t level;
+    const void *key = tag;
+    const char *name = tag;
+    rt_thread_t thread;
+
+    if (key == RT_NULL && rt_interrupt_get_nest() == 0)
+    {
+        thread = rt_thread_self();
+        if (thread != RT_NULL)
+        {
+            key  = thread;
+            name = rt_object_get_name((rt_object_t)thread);
+        }
+    }
+
+    level = SMEM_OWNER_LOCK();
+    _smem_owner_add(small_mem, (struct rt_small_mem_item *)((rt_uint8_t *)rmem - SIZEOF_STRUCT_MEM),
+                    _smem_owner_index(small_mem, key, name));
+    SMEM_OWNER_UNLOCK(level);
+}
+
+/* ͷŵĿȥ */
+static void _smem_owner_give(struct rt_small_mem *small_mem, void *rmem)
+{
+    rt_base_t level;
+
+    level = SMEM_OWNER_LOCK();
+    _smem_owner_sub(small_mem, (struct rt_small_mem_item *)((rt_uint8_t *)rmem - SIZEOF_STRUCT_MEM));
+    SMEM_OWNER_UNLOCK(level);
+}
+
+/* Ѳڵļ κ̺߳tag еĿͷ󼴿øµ */
+static const char _smem_owner_gone[] = "";
+
+/**
+ * @brief This function will forget an owner in all the small memory heaps. The
+ *        blocks it still owns stay charged to its name, but a thread created
+ *        later at the same address is accounted apart. It is invoked when a
+ *        thread is detached or deleted.
+ *
+ * @param key the thread.
+ */
+void rt_smem_owner_forget(const void *key)
+{
+    int index;
+    rt_base_t level;
+    struct rt_list_node *node;
+    struct rt_object_information *information;
+    struct rt_small_mem *small_mem;
+
+    information = rt_object_get_information(RT_Object_Class_Memory);
+    if (key == RT_NULL || information == RT_NULL)
+        return;
+
+    /* ߳Ѿٷ жϺû */
+    level = rt_hw_interrupt_disable();
+    rt_list_for_each(node, &(information->object_list))
+    {
+        small_mem = (struct rt_small_mem *)rt_list_entry(node, struct rt_object, list);
+        if (rt_strncmp(small_mem->parent.algorithm, "small", 5) != 0)
+            continue;
+
+        for (index = 1; index < RT_SMALL_MEM_OWNER_NR; index ++)
+        {
+            if (small_mem->owner[index].key == key)
+                small_mem->owner[index].key = _smem_owner_gone;
+        }
+    }
+    rt_hw_interrupt_enable(level);
+}
+RTM_EXPORT(rt_smem_owner_forget);
+
+#define SMEM_OWNER_TAKE(_heap, _ptr, _tag)              \
+    do { if ((_ptr) != RT_NULL) _smem_owner_take((_heap), (_ptr), (_tag)); } while (0)
+#define SMEM_OWNER_GIVE(_heap, _ptr)    _smem_owner_give((_heap), (_ptr))
+#else
+#define SMEM_OWNER_TAKE(_heap, _ptr, _tag)
+#define SMEM_OWNER_GIVE(_heap, _ptr)
+#endif /* RT_USING_SMALL_MEM_OWNER */
+
+#ifdef RT_USING_SMALL_MEM_GUARD
+/* ÿ۵ֽ */
+#define SMEM_GUARD_SLOT_BYTES   RT_ALIGN(RT_SMALL_MEM_GUARD_SLOT_SIZE + 2 * RT_SMALL_MEM_GUARD_REDZONE, RT_ALIGN_SIZE)
+#define SMEM_GUARD_AREA_BYTES   (SMEM_GUARD_SLOT_BYTES * RT_SMALL_MEM_GUARD_SLOT_NR)
+/* Ϳв۵ֵ */
+#define SMEM_GUARD_RED          0xa5
+#define SMEM_GUARD_FREED        0xdd
+
+#define SMEM_GUARD_SLOT_BASE(_heap, _index) ((_heap)->guard_area + (_index) * SMEM_GUARD_SLOT_BYTES)
+
+/* б۵Ķ */
+static struct rt_small_mem *_smem_guard_list = RT_NULL;
+/* ⵽ʱĻص */
+static void (*_smem_guard_hook)(rt_smem_t m, void *ptr, rt_uint32_t error) = RT_NULL;
+
+/**
+ * @brief This function will set a hook function, which will be invoked when
+ *        the guarded slots detect a memory error.
+ *
+ * @param hook the hook function. ptr is the block involved and error is one
+ *        of RT_SMEM_GUARD_OVERFLOW, RT_SMEM_GUARD_USE_AFTER_FREE,
+ *        RT_SMEM_GUARD_DOUBLE_FREE and RT_SMEM_GUARD_INVALID_FREE.
+ */
+void rt_smem_guard_sethook(void (*hook)(rt_smem_t m, void *ptr, rt_uint32_t error))
+{
+    _smem_guard_hook = hook;
+}
+RTM_EXPORT(rt_smem_guard_sethook);
+
+/* һγǰķ [rate/2, rate*3/2) ǳͬһλõķ */
+static rt_uint32_t _smem_guard_interval(struct rt_small_mem *small_mem)
+{
+    if (small_mem->guard_rate == 0 || small_mem->guard_area == RT_NULL)
+        return 0;
+
+    small_mem->guard_seed = small_mem->guard_seed * 1103515245 + 12345;
+
+    return small_mem->guard_rate / 2 + (small_mem->guard_seed >> 16) % small_mem->guard_rate + 1;
+}
+
+/* [begin, end)еһvalueֽ ȫʱRT_NULL */
+static rt_uint8_t *_smem_guard_scan(rt_uint8_t *begin, rt_uint8_t *end, rt_uint8_t value)
+{
+    for (; begin < end; begin ++)
+    {
+        if (*begin != value)
+            return begin;
+    }
+
+    return RT_NULL;
+}
+
+/* ǰ߳ */
+static void _smem_guard_name(char *name)
+{
+    rt_thread_t thread = RT_NULL;
+
+    if (rt_interrupt_get_nest() == 0)
+        thread = rt_thread_self();
+    rt_strncpy(name, thread != RT_NULL ? rt_object_get_name((rt_object_t)thread) : "(isr)", RT_NAME_MAX);
+}
+
+/*  */
+static void _smem_guard_report(struct rt_small_mem *small_mem, int index, void *ptr,
+                               rt_uint8_t *where, rt_uint32_t error)
+{
+    struct rt_smem_guard_slot *slot = &small_mem->guard_slot[index];
+    static const char *const error_name[] =
+    {
+        "", "heap overflow", "use after free", "double free", "invalid free"
+    };
+
+    small_mem->guard_errors ++;
+    rt_kprintf("smem guard: %s on 0x%x in %.*s slot %d, byte 0x%x\n", error_name[error],
+               (rt_ubase_t)ptr, RT_NAME_MAX, rt_object_get_name(&(small_mem->parent.parent)), index, (rt_ubase_t)where);
+    rt_kprintf("  block 0x%x size %d, allocated by %.*s", (rt_ubase_t)slot->data, slot->size,
+               RT_NAME_MAX, slot->alloc_name);
+    if (!slot->used)
+        rt_kprintf(", released by %.*s", RT_NAME_MAX, slot->free_name);
+    rt_kprintf("\n");
+
+    if (_smem_guard_hook != RT_NULL)
+        _smem_guard_hook(&small_mem->parent, ptr, error);
+}
+
+/* һ ִʱ沢޸ֵ ͬһ󱻷 */
+static rt_uint32_t _smem_guard_verify(struct rt_small_mem *small_mem, int index)
+{
+    rt_uint8_t *base, *end, *where;
+    struct rt_smem_guard_slot *slot = &small_mem->guard_slot[index];
+
+    base = SMEM_GUARD_SLOT_BASE(small_mem, index);
+    end  = base + SMEM_GUARD_SLOT_BYTES;
+    if (slot->used)
+    {
+        /* ǰĺ */
+        where = _smem_guard_scan(base, slot->data, SMEM_GUARD_RED);
+        if (where == RT_NULL)
+            where = _smem_guard_scan(slot->data + slot->size, end, SMEM_GUARD_RED);
+        if (where == RT_NULL)
+            return 0;
+
+        _smem_guard_report(small_mem, index, slot->data, where, RT_SMEM_GUARD_OVERFLOW);
+        rt_memset(base, SMEM_GUARD_RED, slot->data - base);
+        rt_memset(slot->data + slot->size, SMEM_GUARD_RED, end - (slot->data + slot->size));
+    }
+    else
+    {
+        /* ͷź۶Ӧٱд */
+        where = _smem_guard_scan(base, end, SMEM_GUARD_FREED);
+        if (where == RT_NULL)
+            return 0;
+
+        _smem_guard_report(small_mem, index, slot->data, where, RT_SMEM_GUARD_USE_AFTER_FREE);
+        rt_memset(base, SMEM_GUARD_FREED, SMEM_GUARD_SLOT_BYTES);
+    }
+
+    return 1;
+}
+
+/* ӱз䱣ڵڴ Ǽǵб۵Ķ */
+static void _smem_guard_init(struct rt_small_mem *small_mem)
+{
+    rt_base_t level;
+
+    small_mem->guard_area = (rt_uint8_t *)_smem_alloc_block(small_mem, SMEM_GUARD_AREA_BYTES);
+    if (small_mem->guard_area == RT_NULL)
+        return;
+
+    rt_memset(small_mem->guard_area, SMEM_GUARD_FREED, SMEM_GUARD_AREA_BYTES);
+    small_mem->guard_rate      = RT_SMALL_MEM_GUARD_RATE;
+    small_mem->guard_seed      = (rt_uint32_t)(rt_ubase_t)small_mem;
+    small_mem->guard_countdown = _smem_guard_interval(small_mem);
+
+    level = rt_hw_interrupt_disable();
+    small_mem->guard_next = _smem_guard_list;
+    _smem_guard_list = small_mem;
+    rt_hw_interrupt_enable(level);
+}
+
+/* б۵Ķȥ */
+static void _smem_guard_detach(struct rt_small_mem *small_mem)
+{
+    rt_base_t level;
+    struct rt_small_mem **node;
+
+    level = rt_hw_interrupt_disable();
+    for (node = &_smem_guard_list; *node != RT_NULL; node = &(*node)->guard_next)
+    {
+        if (*node == small_mem)
+        {
+            *node = small_mem->guard_next;
+            break;
+        }
+    }
+    rt_hw_interrupt_enable(level);
+}
+
+/* ҵַڵıĶ καʱRT_NULL */
+rt_inline struct rt_small_mem *_smem_guard_find(void *rmem)
+{
+    struct rt_small_mem *small_mem;
+
+    for (small_mem = _smem_guard_list; small_mem != RT_NULL; small_mem = small_mem->guard_next)
+    {
+        if ((rt_uint8_t *)rmem >= small_mem->guard_area &&
+            (rt_uint8_t *)rmem <  small_mem->guard_area + SMEM_GUARD_AREA_BYTES)
+            return small_mem;
+    }
+
+    return RT_NULL;
+}
+
+/* һγеķͷŵĿв ݽĺ ûпвʱRT_NULL */
+static void *_smem_guard_alloc(struct rt_small_mem *small_mem, rt_size_t size)
+{
+    int index, found = -1;
+    rt_uint8_t *base, *end;
+    struct rt_smem_guard_slot *slot;
+
+    small_mem->guard_countdown = _smem_guard_interval(small_mem);
+    if (size > RT_SMALL_MEM_GUARD_SLOT_SIZE)
+        return RT_NULL;
+
+    /* ͷŵĲ ʹͷźĿ龡 */
+    for (index = 0; index < RT_SMALL_MEM_GUARD_SLOT_NR; index ++)
+    {
+        slot = &small_mem->guard_slot[index];
+        if (!slot->used && (found < 0 || slot->free_seq < small_mem->guard_slot[found].free_seq))
+            found = index;
+    }
+    if (found < 0)
+        return RT_NULL;
+
+    /* ǰȷͷźûбд */
+    _smem_guard_verify(small_mem, found);
+
+    slot = &small_mem->guard_slot[found];
+    base = SMEM_GUARD_SLOT_BASE(small_mem, found);
+    end  = base + SMEM_GUARD_SLOT_BYTES;
+    slot->data = (rt_uint8_t *)RT_ALIGN_DOWN((rt_ubase_t)end - RT_SMALL_MEM_GUARD_REDZONE - size, RT_ALIGN_SIZE);
+    slot->size = (rt_uint16_t)size;
+    slot->used = RT_TRUE;
+    _smem_guard_name(slot->alloc_name);
+    rt_memset(base, SMEM_GUARD_RED, slot->data - base);
+    rt_memset(slot->data + size, SMEM_GUARD_RED, end - (slot->data + size));
+    small_mem->guard_sampled ++;
+
+    return slot->data;
+}
+
+/* ͷűеĿ Ϊͷֵ */
+static void _smem_guard_free(struct rt_small_mem *small_mem, void *rmem)
+{
+    int index;
+    struct rt_smem_guard_slot *slot;
+
+    index = ((rt_uint8_t *)rmem - small_mem->guard_area) / SMEM_GUARD_SLOT_BYTES;
+    slot  = &small_mem->guard_slot[index];
+    if (rmem != slot->data)
+    {
+        _smem_guard_report(small_mem, index, rmem, rmem, RT_SMEM_GUARD_INVALID_FREE);
+        return;
+    }
+    if (!slot->used)
+    {
+        _smem_guard_report(small_mem, index, rmem, rmem, RT_SMEM_GUARD_DOUBLE_FREE);
+        return;
+    }
+
+    _smem_guard_verify(small_mem, index);
+
+    rt_memset(SMEM_GUARD_SLOT_BASE(small_mem, index), SMEM_GUARD_FREED, SMEM_GUARD_SLOT_BYTES);
+    slot->used = RT_FALSE;
+    slot->free_seq = ++ small_mem->guard_seq;
+    _smem_guard_name(slot->free_name);
+}
+
+/**
+ * @brief This function will set the sampling rate of the guarded slots.
+ *
+ * @param m the small memory management object.
+ *
+ * @param rate one of about 'rate' allocations is placed in a guarded slot,
+ *        0 to stop sampling. The blocks already in slots are still checked.
+ *
+ * @return the operation status, RT_EOK on successful, -RT_ENOSYS if the heap
+ *         has no guarded slots.
+ */
+rt_err_t rt_smem_guard_set_rate(rt_smem_t m, rt_uint32_t rate)
+{
+    struct rt_small_mem *small_mem;
+
+    RT_ASSERT(m != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&m->parent) == RT_Object_Class_Memory);
+
+    small_mem = (struct rt_small_mem *)m;
+    if (small_mem->guard_area == RT_NULL)
+        return -RT_ENOSYS;
+
+    small_mem->guard_rate      = rate;
+    small_mem->guard_countdown = _smem_guard_interval(small_mem);
+
+    return RT_EOK;
+}
+RTM_EXPORT(rt_smem_guard_set_rate);
+
+/**
+ * @brief This function will check the red zones of the used slots and the
+ *        fill of the released slots. It shall be invoked with the heap locked,
+ *        the same as rt_smem_free.
+ *
+ * @param m the small memory management object.
+ *
+ * @return the number of errors found.
+ */
+rt_uint32_t rt_smem_guard_check(rt_smem_t m)
+{
+    int index;
+    rt_uint32_t errors = 0;
+    struct rt_small_mem *small_mem;
+
+    RT_ASSERT(m != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&m->parent) == RT_Object_Class_Memory);
+
+    small_mem = (struct rt_small_mem *)m;
+    if (small_mem->guard_area == RT_NULL)
+        return 0;
+
+    for (index = 0; index < RT_SMALL_MEM_GUARD_SLOT_NR; index ++)
+        errors += _smem_guard_verify(small_mem, index);
+
+    return errors;
+}
+RTM_EXPORT(rt_smem_guard_check);
+
+/**
+ * @brief This function will check a few guarded slots of every small memory
+ *        heap. It is invoked by the idle thread.
+ *
+ * @return -RT_EBUSY if a heap is in the middle of a pass over its slots,
+ *         -RT_EEMPTY if the passes of all heaps are finished.
+ */
+rt_err_t rt_smem_guard_step(void)
+{
+    int count;
+    rt_err_t result = -RT_EEMPTY;
+    struct rt_small_mem *small_mem;
+
+    /* ֻ۶ѵ ʱкrt_smem_freeͬĶ */
+    rt_enter_critical();
+    for (small_mem = _smem_guard_list; small_mem != RT_NULL; small_mem = small_mem->guard_next)
+    {
+        /* ̳߳ һټ ߿ ֻCPUһֱ */
+        if (_smem_lock(small_mem, 0) != RT_EOK)
+            continue;
+        for (count = 0; count < RT_SMALL_MEM_GUARD_BUDGET; count ++)
+        {
+            _smem_guard_verify(small_mem, small_mem->guard_check);
+            small_mem->guard_check = (small_mem->guard_check + 1) % RT_SMALL_MEM_GUARD_SLOT_NR;
+            /* һ ֽ */
+            if (small_mem->guard_check == 0)
+                break;
+        }
+        if (small_mem->guard_check != 0)
+            result = -RT_EBUSY;
+        _smem_unlock(small_mem);
+    }
+    rt_exit_critical();
+
+    return result;
+}
+#endif /* RT_USING_SMALL_MEM_GUARD */
+
+#ifdef RT_USING_SMALL_MEM_MAGAZINE
+/* ÿCPUĻ水16ֽڻֳߴȼ */
+#define MAGAZINE_SHIFT       4
+#define MAGAZINE_MAX_SIZE    (RT_SMALL_MEM_MAGAZINE_CLASS_NR << MAGAZINE_SHIFT)
+/* /黹Ŀ Ϊһ */
+#define MAGAZINE_BATCH       (RT_SMALL_MEM_MAGAZINE_SIZE / 2)
+
+#ifdef RT_USING_SMP
+#define MAGAZINE_CPU_ID()    rt_hw_cpu_id()
+#else
+#define MAGAZINE_CPU_ID()    0
+#endif /* RT_USING_SMP */
+
+/* С㻺ȼ ȡ ֤ȼеĿ鶼õȼ */
+#define MAGAZINE_CLASS(_size) (((_size) >> MAGAZINE_SHIFT) - 1)
+
+/**
+ * @brief This function will return all blocks cached in the magazines to the free lists.
+ *
+ * @param m the small memory management object.
+ */
+void rt_smem_magazine_flush(rt_smem_t m)
+{
+    int cpu, class_index;
+    rt_base_t level;
+    struct rt_small_mem *small_mem;
+    struct rt_small_mem_magazine *mag;
+
+    RT_ASSERT(m != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&m->parent) == RT_Object_Class_Memory);
+
+    small_mem = (struct rt_small_mem *)m;
+    for (cpu = 0; cpu < RT_CPUS_NR; cpu ++)
+    {
+        for (class_index = 0; class_index < RT_SMALL_MEM_MAGAZINE_CLASS_NR; class_index ++)
+        {
+            /* ÿ浥ж ⳤʱж */
+            level = rt_hw_interrupt_disable();
+            mag = &small_mem->magazine[cpu][class_index];
+            while (mag->count > 0)
+            {
+                _smem_free_block(small_mem,
+                                 (struct rt_small_mem_item *)((rt_uint8_t *)mag->rounds[-- mag->count] - SIZEOF_STRUCT_MEM));
+            }
+            rt_hw_interrupt_enable(level);
+        }
+    }
+}
+RTM_EXPORT(rt_smem_magazine_flush);
+
+/**
+ * @brief This function will allocate a small block from the magazine of current cpu only.
+ *        It never touches the free lists, so it can be invoked before taking the heap lock.
+ *
+ * @param m the small memory management object.
+ *
+ * @param size is the minimum size of the requested block in bytes.
+ *
+ * @return the pointer to allocated memory or RT_NULL if the magazine is empty.
+ */
+void *rt_smem_magazine_alloc(rt_smem_t m, rt_size_t size)
+{
+    void *ptr = RT_NULL;
+    rt_base_t level;
+    struct rt_small_mem *small_mem;
+    struct rt_small_mem_magazine *mag;
+
+    RT_ASSERT(m != RT_NULL);
+
+    if (size == 0 || size > MAGAZINE_MAX_SIZE)
+        return RT_NULL;
+
+    small_mem = (struct rt_small_mem *)m;
+
+    level = rt_hw_interrupt_disable();
+    mag = &small_mem->magazine[MAGAZINE_CPU_ID()][MAGAZINE_CLASS(RT_ALIGN(size, 1 << MAGAZINE_SHIFT))];
+    if (mag->count > 0)
+    {
+        ptr = mag->rounds[-- mag->count];
+        mag->hit ++;
+    }
+    rt_hw_interrupt_enable(level);
+
+    if (ptr != RT_NULL)
+        SMEM_TRACE(small_mem, RT_SMEM_TRACE_ALLOC, size, 0, SMEM_TRACE_HANDLE(small_mem, ptr));
+    SMEM_OWNER_TAKE(small_mem, ptr, RT_NULL);
+
+    return ptr;
+}
+RTM_EXPORT(rt_smem_magazine_alloc);
+
 /**
- * Base structure of small memory object
+ * @brief This function will put a small block into the magazine of current cpu only.
+ *        It never touches the free lists, so it can be invoked before taking the heap lock.
+ *
+ * @param rmem the address of memory which will be released.
+ *
+ * @return RT_TRUE if the block is cached, RT_FALSE if it shall be released by rt_smem_free.
  */
-/* ڴϢ */
-struct rt_small_mem
+rt_bool_t rt_smem_magazine_free(void *rmem)
 {
-    /* ̳rt_memory */
-    struct rt_memory            parent;                 /**< inherit from rt_memory */
-    /* ڴѵʼַ */
-    rt_uint8_t                 *heap_ptr;               /**< pointer to the heap */
-    /* ڴѽβͷַ */
-    struct rt_small_mem_item   *heap_end;
-    /* ָһеڴͷ */
-    struct rt_small_mem_item   *lfree;
-    /* ڴ */
-    rt_size_t                   mem_size_aligned;       /**< aligned memory size */
-};
+    rt_size_t size;
+    rt_base_t level;
+    rt_bool_t cached = RT_FALSE;
+    struct rt_small_mem *small_mem;
+    struct rt_small_mem_item *mem;
+    struct rt_small_mem_magazine *mag;
 
-#define HEAP_MAGIC 0x1ea0
-/* Сֽ */
-#define MIN_SIZE 12
+    if (rmem == RT_NULL)
+        return RT_TRUE;
+#ifdef RT_USING_SMALL_MEM_GUARD
+    /* еĿûͷ rt_smem_freeͷ */
+    if (_smem_guard_find(rmem) != RT_NULL)
+        return RT_FALSE;
+#endif /* RT_USING_SMALL_MEM_GUARD */
 
-#define MEM_MASK             0xfffffffe
-#define MEM_USED()         ((((rt_base_t)(small_mem)) & MEM_MASK) | 0x1)
-#define MEM_FREED()        ((((rt_base_t)(small_mem)) & MEM_MASK) | 0x0)
-#define MEM_ISUSED(_mem)   \
-                      (((rt_base_t)(((struct rt_small_mem_item *)(_mem))->pool_ptr)) & (~MEM_MASK))
-#define MEM_POOL(_mem)     \
-    ((struct rt_small_mem *)(((rt_base_t)(((struct rt_small_mem_item *)(_mem))->pool_ptr)) & (MEM_MASK)))
-#define MEM_SIZE(_heap, _mem)      \
-    (((struct rt_small_mem_item *)(_mem))->next - ((rt_ubase_t)(_mem) - \
-    (rt_ubase_t)((_heap)->heap_ptr)) - RT_ALIGN(sizeof(struct rt_small_mem_item), RT_ALIGN_SIZE))
-/* СĴ4ֽڵĶ */
-#define MIN_SIZE_ALIGNED     RT_ALIGN(MIN_SIZE, RT_ALIGN_SIZE)
-#define SIZEOF_STRUCT_MEM    RT_ALIGN(sizeof(struct rt_small_mem_item), RT_ALIGN_SIZE)
+    mem = (struct rt_small_mem_item *)((rt_uint8_t *)rmem - SIZEOF_STRUCT_MEM);
+    small_mem = MEM_POOL(mem);
+    RT_ASSERT(MEM_ISUSED(mem));
+    RT_ASSERT(rt_object_get_type(&small_mem->parent.parent) == RT_Object_Class_Memory);
 
-/* ڴͷʱڵϲ  */
-static void plug_holes(struct rt_small_mem *m, struct rt_small_mem_item *mem)
+    size = MEM_SIZE(small_mem, mem);
+    if (size < (1 << MAGAZINE_SHIFT) || size > MAGAZINE_MAX_SIZE)
+        return RT_FALSE;
+
+    level = rt_hw_interrupt_disable();
+    mag = &small_mem->magazine[MAGAZINE_CPU_ID()][MAGAZINE_CLASS(size)];
+    if (mag->count < RT_SMALL_MEM_MAGAZINE_SIZE)
+    {
+#ifdef RT_USING_SMALL_MEM_OWNER
+        /* 뻺ǰȥ CPUȡ */
+        _smem_owner_sub(small_mem, mem);
+#endif /* RT_USING_SMALL_MEM_OWNER */
+        mag->rounds[mag->count ++] = rmem;
+        cached = RT_TRUE;
+    }
+    rt_hw_interrupt_enable(level);
+
+    if (cached)
+        SMEM_TRACE(small_mem, RT_SMEM_TRACE_FREE, 0, SMEM_TRACE_HANDLE(small_mem, rmem), 0);
+
+    return cached;
+}
+RTM_EXPORT(rt_smem_magazine_free);
+
+/* ӻз Ϊʱӿ */
+static void *_smem_magazine_alloc(struct rt_small_mem *small_mem, rt_size_t size)
 {
-    struct rt_small_mem_item *nmem; /* һСڴĽڵϢ  */
-    struct rt_small_mem_item *pmem; /* һСڴĽڵϢ  */
+    int index;
+    void *ptr;
+    rt_base_t level;
+    struct rt_small_mem_magazine *mag;
 
-    RT_ASSERT((rt_uint8_t *)mem >= m->heap_ptr);
-    RT_ASSERT((rt_uint8_t *)mem < (rt_uint8_t *)m->heap_end);
+    /* ȼС ͬһȼĿԻิ */
+    size = RT_ALIGN(size, 1 << MAGAZINE_SHIFT);
 
-    /* plug hole forward */
-    nmem = (struct rt_small_mem_item *)&m->heap_ptr[mem->next];/* ȡǰڴһڴĵַ */
-    if (mem != nmem && !MEM_ISUSED(nmem) &&
-        (rt_uint8_t *)nmem != (rt_uint8_t *)m->heap_end)
+    level = rt_hw_interrupt_disable();
+    mag = &small_mem->magazine[MAGAZINE_CPU_ID()][MAGAZINE_CLASS(size)];
+    if (mag->count == 0)
     {
-        /* if mem->next is unused and not end of m->heap_ptr,
-         * combine mem and mem->next
-         */
-        if (m->lfree == nmem)
+        /*  һֻһ ֮ͷռ */
+        for (index = 0; index < MAGAZINE_BATCH; index ++)
         {
-            m->lfree = mem;
+            ptr = _smem_alloc_block(small_mem, size);
+            if (ptr == RT_NULL)
+                break;
+            mag->rounds[mag->count ++] = ptr;
+        }
+        mag->refill ++;
+
+        if (mag->count == 0)
+        {
+            rt_hw_interrupt_enable(level);
+
+            /* пܶѹڻ 黹һ */
+            rt_smem_magazine_flush(&small_mem->parent);
+
+            level = rt_hw_interrupt_disable();
+            ptr = _smem_alloc_block(small_mem, size);
+            rt_hw_interrupt_enable(level);
+
+            return ptr;
         }
-        nmem->pool_ptr = 0;
-        mem->next = nmem->next;
-        ((struct rt_small_mem_item *)&m->heap_ptr[nmem->next])->prev = (rt_uint8_t *)mem - m->heap_ptr;
     }
+    else
+    {
+        mag->hit ++;
+    }
+    ptr = mag->rounds[-- mag->count];
+    rt_hw_interrupt_enable(level);
 
-    /* plug hole backward */
-    pmem = (struct rt_small_mem_item *)&m->heap_ptr[mem->prev];
-    if (pmem != mem && !MEM_ISUSED(pmem))
+    return ptr;
+}
+
+/* ͷŵ ʱ黹 */
+static void _smem_magazine_free(struct rt_small_mem *small_mem, struct rt_small_mem_item *mem)
+{
+    int index;
+    rt_base_t level;
+    struct rt_small_mem_magazine *mag;
+
+    level = rt_hw_interrupt_disable();
+    mag = &small_mem->magazine[MAGAZINE_CPU_ID()][MAGAZINE_CLASS(MEM_SIZE(small_mem, mem))];
+    if (mag->count == RT_SMALL_MEM_MAGAZINE_SIZE)
     {
-        /* if mem->prev is unused, combine mem and mem->prev */
-        if (m->lfree == mem)
+        /* 黹绺һ ͷŵĿڻ */
+        for (index = 0; index < MAGAZINE_BATCH; index ++)
         {
-            m->lfree = pmem;
+            _smem_free_block(small_mem,
+                             (struct rt_small_mem_item *)((rt_uint8_t *)mag->rounds[index] - SIZEOF_STRUCT_MEM));
         }
-        mem->pool_ptr = 0;
-        pmem->next = mem->next;
-        ((struct rt_small_mem_item *)&m->heap_ptr[mem->next])->prev = (rt_uint8_t *)pmem - m->heap_ptr;
+        for (index = MAGAZINE_BATCH; index < RT_SMALL_MEM_MAGAZINE_SIZE; index ++)
+        {
+            mag->rounds[index - MAGAZINE_BATCH] = mag->rounds[index];
+        }
+        mag->count -= MAGAZINE_BATCH;
+        mag->drain ++;
+    }
+    mag->rounds[mag->count ++] = (rt_uint8_t *)mem + SIZEOF_STRUCT_MEM;
+    rt_hw_interrupt_enable(level);
+}
+
+#endif /* RT_USING_SMALL_MEM_MAGAZINE */
+
+/* Ѷsizeֽ СȴӱCPUĻȡ */
+static void *_smem_alloc(struct rt_small_mem *small_mem, rt_size_t size)
+{
+#ifdef RT_USING_SMALL_MEM_MAGAZINE
+    if (size <= MAGAZINE_MAX_SIZE)
+        return _smem_magazine_alloc(small_mem, size);
+#endif /* RT_USING_SMALL_MEM_MAGAZINE */
+
+    return _smem_alloc_block(small_mem, size);
+}
+
+/* ͷһʹõĿ Сȷ뱾CPUĻ */
+static void _smem_free(struct rt_small_mem *small_mem, struct rt_small_mem_item *mem)
+{
+#ifdef RT_USING_SMALL_MEM_MAGAZINE
+    if (MEM_SIZE(small_mem, mem) >= (1 << MAGAZINE_SHIFT) &&
+        MEM_SIZE(small_mem, mem) <= MAGAZINE_MAX_SIZE)
+    {
+        _smem_magazine_free(small_mem, mem);
+        return;
+    }
+#endif /* RT_USING_SMALL_MEM_MAGAZINE */
+
+#ifdef RT_USING_SMALL_MEM_DEFER
+    /* ֻҵӳͷ ϲ̻߳ʧʱ ʱֱӺϲ */
+    if (small_mem->defer_count < RT_SMALL_MEM_DEFER_MAX)
+    {
+        rt_base_t level;
+
+        level = rt_hw_interrupt_disable();
+        MEM_FREE_NODE(mem)->free_next = small_mem->defer_list;
+        small_mem->defer_list = mem;
+        small_mem->defer_count ++;
+        if (small_mem->defer_count > small_mem->defer_max)
+            small_mem->defer_max = small_mem->defer_count;
+        rt_hw_interrupt_enable(level);
+        return;
+    }
+#endif /* RT_USING_SMALL_MEM_DEFER */
+
+    _smem_free_block(small_mem, mem);
+}
+
+#ifdef RT_USING_SMALL_MEM_DEFER
+/**
+ * @brief This function will coalesce the blocks whose release was deferred.
+ *        It shall be invoked with the heap locked, the same as rt_smem_free.
+ *
+ * @param m the small memory management object.
+ *
+ * @param budget the maximum number of blocks to coalesce, 0 for all.
+ *
+ * @return the number of blocks still waiting.
+ */
+rt_uint32_t rt_smem_defer_flush(rt_smem_t m, rt_uint32_t budget)
+{
+    RT_ASSERT(m != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&m->parent) == RT_Object_Class_Memory);
+
+    return _smem_defer_merge((struct rt_small_mem *)m, budget);
+}
+RTM_EXPORT(rt_smem_defer_flush);
+
+/**
+ * @brief This function will coalesce a few deferred blocks of every small
+ *        memory heap. It is invoked by the idle thread.
+ *
+ * @return -RT_EBUSY if there are still deferred blocks to coalesce,
+ *         -RT_EEMPTY if there are none, or the heaps holding them are locked.
+ */
+rt_err_t rt_smem_defer_step(void)
+{
+    rt_err_t result = -RT_EEMPTY;
+    struct rt_list_node *node;
+    struct rt_object_information *information;
+    struct rt_memory *m;
+
+    information = rt_object_get_information(RT_Object_Class_Memory);
+    if (information == RT_NULL)
+        return -RT_EEMPTY;
+
+    /* ֻѶ ϲʱкrt_smem_freeͬĶ */
+    rt_enter_critical();
+    rt_list_for_each(node, &(information->object_list))
+    {
+        m = (struct rt_memory *)rt_list_entry(node, struct rt_object, list);
+        if (rt_strncmp(m->algorithm, "small", 5) != 0)
+            continue;
+
+        if (((struct rt_small_mem *)m)->defer_list == RT_NULL)
+            continue;
+        /* ̳߳ һٺϲ ߿ ֻCPUһֱ */
+        if (_smem_lock((struct rt_small_mem *)m, 0) != RT_EOK)
+            continue;
+        if (_smem_defer_merge((struct rt_small_mem *)m, RT_SMALL_MEM_DEFER_BUDGET) != 0)
+            result = -RT_EBUSY;
+        _smem_unlock((struct rt_small_mem *)m);
     }
+    rt_exit_critical();
+
+    return result;
 }
+#endif /* RT_USING_SMALL_MEM_DEFER */
 
 /**
  * @brief This function will initialize small memory management algorithm.
@@ -209,6 +1768,9 @@ rt_smem_t rt_smem_init(const char    *name,
     small_mem->mem_size_aligned = mem_size;
     /* ָѵʼַ  */
     small_mem->heap_ptr = (rt_uint8_t *)begin_align;
+#ifdef RT_USING_SMALL_MEM_OWNER
+    rt_strncpy(small_mem->owner[0].name, "(other)", RT_NAME_MAX);
+#endif /* RT_USING_SMALL_MEM_OWNER */
 
     RT_DEBUG_LOG(RT_DEBUG_MEM, ("mem init, heap begin address 0x%x, size %d\n",
                                 (rt_ubase_t)small_mem->heap_ptr, small_mem->mem_size_aligned));
@@ -231,8 +1793,11 @@ rt_smem_t rt_smem_init(const char    *name,
     /* Ϊѽͷĵַ */
     small_mem->heap_end->prev  = small_mem->mem_size_aligned + SIZEOF_STRUCT_MEM;
 
-    /* lfreeָһеСڴ ʼΪһݵͷ */
-    small_mem->lfree = (struct rt_small_mem_item *)small_mem->heap_ptr;
+    /* ʼʱѾһп  */
+    _smem_free_insert(small_mem, mem);
+#ifdef RT_USING_SMALL_MEM_GUARD
+    _smem_guard_init(small_mem);
+#endif /* RT_USING_SMALL_MEM_GUARD */
 
     return &small_mem->parent;
 }
@@ -251,6 +1816,9 @@ rt_err_t rt_smem_detach(rt_smem_t m)
     RT_ASSERT(m != RT_NULL);
     RT_ASSERT(rt_object_get_type(&m->parent) == RT_Object_Class_Memory);
     RT_ASSERT(rt_object_is_systemobject(&m->parent));
+#ifdef RT_USING_SMALL_MEM_GUARD
+    _smem_guard_detach((struct rt_small_mem *)m);
+#endif /* RT_USING_SMALL_MEM_GUARD */
     /* Сڴ㷨Ķ */
     rt_object_detach(&(m->parent));
 
@@ -258,6 +1826,29 @@ rt_err_t rt_smem_detach(rt_smem_t m)
 }
 RTM_EXPORT(rt_smem_detach);
 
+/**
+ * @brief This function will tell a small memory heap the lock its owner takes
+ *        around rt_smem_alloc, rt_smem_free and rt_smem_realloc, for example
+ *        the heap mutex of rt_malloc. The work done on the heap outside these
+ *        calls, by the idle thread and the shell commands, takes the same lock.
+ *        A heap without a lock is assumed to be used with the scheduler locked.
+ *
+ * @param m the small memory management object.
+ *
+ * @param lock the mutex or semaphore, RT_NULL to remove it.
+ */
+void rt_smem_set_lock(rt_smem_t m, rt_object_t lock)
+{
+    RT_ASSERT(m != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&m->parent) == RT_Object_Class_Memory);
+    RT_ASSERT(lock == RT_NULL ||
+              rt_object_get_type(lock) == RT_Object_Class_Mutex ||
+              rt_object_get_type(lock) == RT_Object_Class_Semaphore);
+
+    ((struct rt_small_mem *)m)->lock = lock;
+}
+RTM_EXPORT(rt_smem_set_lock);
+
 /**
  * @addtogroup MM
  */
@@ -276,8 +1867,7 @@ RTM_EXPORT(rt_smem_detach);
 /* ʹСڴ㷨ڴ */
 void *rt_smem_alloc(rt_smem_t m, rt_size_t size)
 {
-    rt_size_t ptr, ptr2;
-    struct rt_small_mem_item *mem, *mem2;
+    void *ptr;
     struct rt_small_mem *small_mem;
     /* ڴ */
     if (size == 0)
@@ -290,115 +1880,313 @@ void *rt_smem_alloc(rt_smem_t m, rt_size_t size)
     /* ڴĴС4ֽڶ */
     if (size != RT_ALIGN(size, RT_ALIGN_SIZE))
     {
-        /* ִ Ͳִ */
-        RT_DEBUG_LOG(RT_DEBUG_MEM, ("malloc size %d, but align to %d\n",
-                                    size, RT_ALIGN(size, RT_ALIGN_SIZE)));
+        /* ִ Ͳִ */
+        RT_DEBUG_LOG(RT_DEBUG_MEM, ("malloc size %d, but align to %d\n",
+                                    size, RT_ALIGN(size, RT_ALIGN_SIZE)));
+    }
+    else
+    {
+        /* ִ Ͳִ */
+        RT_DEBUG_LOG(RT_DEBUG_MEM, ("malloc size %d\n", size));
+    }
+    /* Сڴͷֵ */
+    small_mem = (struct rt_small_mem *)m;
+#ifdef RT_USING_SMALL_MEM_GUARD
+    /* еķ뱣 еĿ鲻 */
+    if (small_mem->guard_countdown != 0 && -- small_mem->guard_countdown == 0)
+    {
+        ptr = _smem_guard_alloc(small_mem, size);
+        if (ptr != RT_NULL)
+        {
+            SMEM_TRACE(small_mem, RT_SMEM_TRACE_ALLOC, size, 0, SMEM_TRACE_HANDLE(small_mem, ptr));
+            return ptr;
+        }
+    }
+#endif /* RT_USING_SMALL_MEM_GUARD */
+    /* ڴĴС ĴС4ֽڶ */
+    ptr = _smem_alloc(small_mem, RT_ALIGN(size, RT_ALIGN_SIZE));
+    SMEM_TRACE(small_mem, RT_SMEM_TRACE_ALLOC, size, 0, SMEM_TRACE_HANDLE(small_mem, ptr));
+    SMEM_OWNER_TAKE(small_mem, ptr, RT_NULL);
+
+    return ptr;
+}
+RTM_EXPORT(rt_smem_alloc);
+
+#ifdef RT_USING_SMALL_MEM_OWNER
+/**
+ * @brief Allocate a block of memory with a minimum of 'size' bytes, which is
+ *        accounted to 'tag' instead of the current thread.
+ *
+ * @param m the small memory management object.
+ *
+ * @param size is the minimum size of the requested block in bytes.
+ *
+ * @param tag the name of the owner, e.g. a module name. It must be a string
+ *        which is never released, the address identifies the owner.
+ *
+ * @return the pointer to allocated memory or NULL if no free memory was found.
+ */
+void *rt_smem_alloc_tag(rt_smem_t m, rt_size_t size, const char *tag)
+{
+    void *ptr;
+    struct rt_small_mem *small_mem;
+
+    if (size == 0)
+        return RT_NULL;
+
+    RT_ASSERT(m != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&m->parent) == RT_Object_Class_Memory);
+    RT_ASSERT(rt_object_is_systemobject(&m->parent));
+    RT_ASSERT(tag != RT_NULL);
+
+    small_mem = (struct rt_small_mem *)m;
+    ptr = _smem_alloc(small_mem, RT_ALIGN(size, RT_ALIGN_SIZE));
+    SMEM_TRACE(small_mem, RT_SMEM_TRACE_ALLOC, size, 0, SMEM_TRACE_HANDLE(small_mem, ptr));
+    SMEM_OWNER_TAKE(small_mem, ptr, tag);
+
+    return ptr;
+}
+RTM_EXPORT(rt_smem_alloc_tag);
+#endif /* RT_USING_SMALL_MEM_OWNER */
+
+/* Ŀ϶ Ҫܷµ1ߴȼĿŹһؿ
+ * СƬ޷ٱʹ ֻ0Ĳ */
+#define SMEM_ALIGN_GAP_MIN   (SIZEOF_STRUCT_MEM + (2 << SMEM_BIN_SHIFT))
+
+/* пmemҪַ
+ * С϶Ტǰһ ʼĿûǰһ ֻܼ */
+rt_inline rt_ubase_t _smem_align_addr(struct rt_small_mem *small_mem, struct rt_small_mem_item *mem, rt_size_t align)
+{
+    rt_ubase_t data, aligned;
+
+    data = (rt_ubase_t)mem + SIZEOF_STRUCT_MEM;
+    aligned = RT_ALIGN(data, align);
+    if (aligned != data && aligned - data < SMEM_ALIGN_GAP_MIN &&
+        (rt_uint8_t *)mem == small_mem->heap_ptr)
+        aligned = RT_ALIGN(data + SMEM_ALIGN_GAP_MIN, align);
+
+    return aligned;
+}
+
+/* align ǰĿ϶һؿǰһ */
+static void *_smem_alloc_align(struct rt_small_mem *small_mem, rt_size_t size, rt_size_t align)
+{
+    rt_uint32_t index, bitmap;
+    rt_ubase_t aligned = 0;
+    rt_size_t ptr, ptr2, next, prev;
+    struct rt_small_mem_item *mem, *mem2;
+
+    size = RT_ALIGN(size, RT_ALIGN_SIZE);
+    if (size < MIN_BLOCK_SIZE)
+        size = MIN_BLOCK_SIZE;
+    if (size > small_mem->mem_size_aligned)
+    {
+        RT_DEBUG_LOG(RT_DEBUG_MEM, ("no memory\n"));
+
+        return RT_NULL;
+    }
+
+    /* 㹻Ŀпʼַ ܷsize ֱӰͨķʽ */
+    mem = _smem_free_find(small_mem, size + align + SMEM_ALIGN_GAP_MIN);
+    if (mem != RT_NULL)
+        aligned = _smem_align_addr(small_mem, mem, align);
+
+    /* ûʱ sizeڵĳߴȼʼ μпڶǷܷsize */
+    bitmap = small_mem->free_bitmap & ~((1ul << _smem_bin_index(size)) - 1);
+    while (bitmap && mem == RT_NULL)
+    {
+        index = __rt_ffs(bitmap) - 1;
+        bitmap &= ~(1ul << index);
+
+        for (mem = small_mem->free_bins[index]; mem != RT_NULL; mem = MEM_FREE_NODE(mem)->free_next)
+        {
+            aligned = _smem_align_addr(small_mem, mem, align);
+            if (aligned + size <= (rt_ubase_t)&small_mem->heap_ptr[mem->next])
+                break;
+        }
+    }
+    if (mem == RT_NULL)
+    {
+        RT_DEBUG_LOG(RT_DEBUG_MEM, ("no memory\n"));
+
+        return RT_NULL;
+    }
+
+    _smem_free_remove(small_mem, mem);
+    if (aligned != (rt_ubase_t)mem + SIZEOF_STRUCT_MEM)
+    {
+        /* ڶַǰµͷ ϶СʱͷḲmem ȡmem */
+        ptr = (rt_uint8_t *)mem - small_mem->heap_ptr;
+        ptr2 = aligned - SIZEOF_STRUCT_MEM - (rt_ubase_t)small_mem->heap_ptr;
+        next = mem->next;
+        prev = mem->prev;
+        mem2 = (struct rt_small_mem_item *)&small_mem->heap_ptr[ptr2];
+        mem2->pool_ptr = MEM_FREED();
+        mem2->next = next;
+        if (mem2->next != small_mem->mem_size_aligned + SIZEOF_STRUCT_MEM)
+        {
+            ((struct rt_small_mem_item *)&small_mem->heap_ptr[mem2->next])->prev = ptr2;
+        }
+
+        if (ptr2 - ptr >= SMEM_ALIGN_GAP_MIN)
+        {
+            /* ǰĿ϶Ϊпһؿ
+             * memԭǿп ǰĿһʹõ Ҫϲ */
+            mem2->prev = ptr;
+            mem->next = ptr2;
+            _smem_free_insert(small_mem, mem);
+        }
+        else
+        {
+            /* ϶̫С ǰһʹõĿ */
+            mem2->prev = prev;
+            ((struct rt_small_mem_item *)&small_mem->heap_ptr[prev])->next = ptr2;
+            small_mem->parent.used += ptr2 - ptr;
+            small_mem->version ++;
+#ifdef RT_USING_SMALL_MEM_OWNER
+            /* ǰһ  ֽ֮ */
+            if (((struct rt_small_mem_item *)&small_mem->heap_ptr[prev])->owner != SMEM_OWNER_NONE)
+            {
+                struct rt_smem_owner *owner;
+
+                owner = &small_mem->owner[((struct rt_small_mem_item *)&small_mem->heap_ptr[prev])->owner];
+                owner->bytes += ptr2 - ptr;
+                if (owner->bytes > owner->max)
+                    owner->max = owner->bytes;
+            }
+#endif /* RT_USING_SMALL_MEM_OWNER */
+        }
+
+        mem = mem2;
+    }
+
+    return _smem_use_block(small_mem, mem, size);
+}
+
+/**
+ * @brief Allocate a block of memory with a minimum of 'size' bytes, whose address is
+ *        aligned to 'align'. The gap before the aligned address is given back to the
+ *        heap, and the block is released by rt_smem_free. rt_smem_realloc keeps the
+ *        alignment only when the block can be resized in place.
+ *
+ * @param m the small memory management object.
+ *
+ * @param size is the minimum size of the requested block in bytes.
+ *
+ * @param align is the alignment, which must be a power of 2.
+ *
+ * @return the pointer to allocated memory or NULL if no free memory was found.
+ */
+void *rt_smem_alloc_align(rt_smem_t m, rt_size_t size, rt_size_t align)
+{
+    void *ptr;
+    struct rt_small_mem *small_mem;
+
+    RT_ASSERT(m != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&m->parent) == RT_Object_Class_Memory);
+    RT_ASSERT(rt_object_is_systemobject(&m->parent));
+    RT_ASSERT((align & (align - 1)) == 0);
+
+    /* ͨѾҪ */
+    if (align <= RT_ALIGN_SIZE)
+        return rt_smem_alloc(m, size);
+
+    if (size == 0)
+        return RT_NULL;
+
+    small_mem = (struct rt_small_mem *)m;
+    ptr = _smem_alloc_align(small_mem, size, align);
+#ifdef RT_USING_SMALL_MEM_DEFER
+    /* ϲӳͷŵĿһ */
+    if (ptr == RT_NULL && small_mem->defer_list != RT_NULL)
+    {
+        _smem_defer_merge(small_mem, 0);
+        small_mem->defer_retry ++;
+        ptr = _smem_alloc_align(small_mem, size, align);
     }
-    else
+#endif /* RT_USING_SMALL_MEM_DEFER */
+    SMEM_TRACE(small_mem, RT_SMEM_TRACE_ALLOC_ALIGN, size, align, SMEM_TRACE_HANDLE(small_mem, ptr));
+    SMEM_OWNER_TAKE(small_mem, ptr, RT_NULL);
+
+    return ptr;
+}
+RTM_EXPORT(rt_smem_alloc_align);
+
+/* ıʹÿĴС newsizeѶҲΪ0 */
+static void *_smem_realloc(struct rt_small_mem *small_mem, void *rmem, rt_size_t newsize)
+{
+    rt_size_t size;
+    rt_size_t ptr;
+    struct rt_small_mem_item *mem, *mem2;
+    void *nmem;
+
+    RT_ASSERT((((rt_ubase_t)rmem) & (RT_ALIGN_SIZE - 1)) == 0);
+    RT_ASSERT((rt_uint8_t *)rmem >= (rt_uint8_t *)small_mem->heap_ptr);
+    RT_ASSERT((rt_uint8_t *)rmem < (rt_uint8_t *)small_mem->heap_end);
+
+    mem = (struct rt_small_mem_item *)((rt_uint8_t *)rmem - SIZEOF_STRUCT_MEM);
+
+    /* current memory block size */
+    ptr = (rt_uint8_t *)mem - small_mem->heap_ptr;
+    size = mem->next - ptr - SIZEOF_STRUCT_MEM;
+    if (size == newsize)
     {
-        /* ִ Ͳִ */
-        RT_DEBUG_LOG(RT_DEBUG_MEM, ("malloc size %d\n", size));
+        /* the size is the same as */
+        return rmem;
     }
-    /* Сڴͷֵ */
-    small_mem = (struct rt_small_mem *)m;
-    /* ڴĴС ĴС4ֽڶ */
-    size = RT_ALIGN(size, RT_ALIGN_SIZE);
-    /* ÿݿĳȱΪMIN_SIZE_ALIGNED Ĭ12ֽ */
-    if (size < MIN_SIZE_ALIGNED)
-        size = MIN_SIZE_ALIGNED;
-    /* жڴĴС Ƿ񳬹 mem_size_alignedΪɹ  */
-    if (size > small_mem->mem_size_aligned)
+
+    if (newsize < size && newsize + SIZEOF_STRUCT_MEM + MIN_BLOCK_SIZE < size)
     {
-        RT_DEBUG_LOG(RT_DEBUG_MEM, ("no memory\n"));
+        /* β㹻 ֱӲֹ黹 */
+        _smem_shrink_block(small_mem, mem, newsize);
+        small_mem->realloc_inplace ++;
 
-        return RT_NULL;
+        return rmem;
     }
-    /*
-         * δ ɹ
-         * ÿһitem */
-    /* (1)ptr = (rt_uint8_t *)small_mem->lfree - small_mem->heap_ptr
-     * 1 һпͷַ -  ʼַ
-     * 2  ptr Сڵ ʣڴ
-     * 3 һ Сڴ */
-
-    /* (2)ptr <= small_mem->mem_size_aligned - size
-     * ڼôڴǷᳬʣڴ */
-
-    /* (3)ptr = ((struct rt_small_mem_item *)&small_mem->heap_ptr[ptr])->next
-     * ɨָһСڴƿ  */
-
-    for (ptr = (rt_uint8_t *)small_mem->lfree - small_mem->heap_ptr;
-         ptr <= small_mem->mem_size_aligned - size;
-         ptr = ((struct rt_small_mem_item *)&small_mem->heap_ptr[ptr])->next)
-    {
-        /* һ һСڴΪ *//* ptr=0 */
-        mem = (struct rt_small_mem_item *)&small_mem->heap_ptr[ptr];
-        /* ҵп пĴСҪĴ ִз
-         * mem->next = small_mem->mem_size_aligned + SIZEOF_STRUCT_MEM */
-        /* ǰitemڴҪĿռϢĿռǾͷ */
-        if ((!MEM_ISUSED(mem)) && (mem->next - (ptr + SIZEOF_STRUCT_MEM)) >= size)
-        {
-            /* ǰitemڴҪĿռϢĿռĶ  */
-            if (mem->next - (ptr + SIZEOF_STRUCT_MEM) >= (size + SIZEOF_STRUCT_MEM + MIN_SIZE_ALIGNED))
-            {
-                /* ָ */
-                /*ptr2 ָǰϢʵڴģһпҪдӦϢ飩*/
-                ptr2 = ptr + SIZEOF_STRUCT_MEM + size;
-                /* ղŵڴ鱻ʹ һڴ mem2 */
-                mem2       = (struct rt_small_mem_item *)&small_mem->heap_ptr[ptr2];
-                /* ״̬Ϊ */
-                mem2->pool_ptr = MEM_FREED();
-                /* mem2ָһڴ ָ֮ǰmemָڴ */
-                mem2->next = mem->next;
-                /* ǰһַָ ֮ǰڴ*/
-                mem2->prev = ptr;
-
-                /* mem֮ǰָmem->next ָptr2 */
-                mem->next = ptr2;
-                /* */
-                if (mem2->next != small_mem->mem_size_aligned + SIZEOF_STRUCT_MEM)
-                {
-                    ((struct rt_small_mem_item *)&small_mem->heap_ptr[mem2->next])->prev = ptr2;
-                }
-                /* ¼ʹõڴС  */
-                small_mem->parent.used += (size + SIZEOF_STRUCT_MEM);
-                if (small_mem->parent.max < small_mem->parent.used)
-                    small_mem->parent.max = small_mem->parent.used;
-            }
-            else
-            {
-                /* ָ ֱӷ*/
-                small_mem->parent.used += mem->next - ((rt_uint8_t *)mem - small_mem->heap_ptr);
-                if (small_mem->parent.max < small_mem->parent.used)
-                    small_mem->parent.max = small_mem->parent.used;
-            }
-        /* ֮ǰĿڴѱʹ */
-        mem->pool_ptr = MEM_USED();
 
-        if (mem == small_mem->lfree)
+    /* ̿Һϲnewsizeʱ ԭչ ƶ */
+    mem2 = (struct rt_small_mem_item *)&small_mem->heap_ptr[mem->next];
+    if (mem2 != small_mem->heap_end && !MEM_ISUSED(mem2) &&
+        newsize <= size + (mem2->next - mem->next))
+    {
+        _smem_free_remove(small_mem, mem2);
+        small_mem->parent.used += mem2->next - mem->next;
+        mem->next = mem2->next;
+        if (mem->next != small_mem->mem_size_aligned + SIZEOF_STRUCT_MEM)
         {
-            /* mem֮һп鲢Ϳָ */
-            while (MEM_ISUSED(small_mem->lfree) && small_mem->lfree != small_mem->heap_end)
-                small_mem->lfree = (struct rt_small_mem_item *)&small_mem->heap_ptr[small_mem->lfree->next];
-
-            RT_ASSERT(((small_mem->lfree == small_mem->heap_end) || (!MEM_ISUSED(small_mem->lfree))));
+            ((struct rt_small_mem_item *)&small_mem->heap_ptr[mem->next])->prev = ptr;
         }
-        RT_ASSERT((rt_ubase_t)mem + SIZEOF_STRUCT_MEM + size <= (rt_ubase_t)small_mem->heap_end);
-        RT_ASSERT((rt_ubase_t)((rt_uint8_t *)mem + SIZEOF_STRUCT_MEM) % RT_ALIGN_SIZE == 0);
-        RT_ASSERT((((rt_ubase_t)mem) & (RT_ALIGN_SIZE - 1)) == 0);
+        /* ̿ͷѾʧ */
+        small_mem->version ++;
 
-        RT_DEBUG_LOG(RT_DEBUG_MEM,
-                     ("allocate memory at 0x%x, size: %d\n",
-                      (rt_ubase_t)((rt_uint8_t *)mem + SIZEOF_STRUCT_MEM),
-                      (rt_ubase_t)(mem->next - ((rt_uint8_t *)mem - small_mem->heap_ptr))));
+        /* ĲΪп黹 */
+        _smem_shrink_block(small_mem, mem, newsize);
+        if (small_mem->parent.max < small_mem->parent.used)
+            small_mem->parent.max = small_mem->parent.used;
+        small_mem->realloc_inplace ++;
 
-        /* سmemṹ֮ڴ */
-        return (rt_uint8_t *)mem + SIZEOF_STRUCT_MEM;
-        }
+        return rmem;
     }
-    return RT_NULL;
+
+    /* β̫С޷ ԭ */
+    if (newsize < size)
+    {
+        small_mem->realloc_inplace ++;
+
+        return rmem;
+    }
+
+    /* expand memory */
+    nmem = _smem_alloc(small_mem, newsize);
+    if (nmem != RT_NULL) /* check memory */
+    {
+        rt_memcpy(nmem, rmem, size < newsize ? size : newsize);
+        _smem_free(small_mem, mem);
+        small_mem->realloc_moved ++;
+    }
+
+    return nmem;
 }
-RTM_EXPORT(rt_smem_alloc);
 
 /**
  * @brief This function will change the size of previously allocated memory block.
@@ -413,9 +2201,6 @@ RTM_EXPORT(rt_smem_alloc);
  */
 void *rt_smem_realloc(rt_smem_t m, void *rmem, rt_size_t newsize)
 {
-    rt_size_t size;
-    rt_size_t ptr, ptr2;
-    struct rt_small_mem_item *mem, *mem2;
     struct rt_small_mem *small_mem;
     void *nmem;
 
@@ -426,9 +2211,12 @@ void *rt_smem_realloc(rt_smem_t m, void *rmem, rt_size_t newsize)
     small_mem = (struct rt_small_mem *)m;
     /* alignment size */
     newsize = RT_ALIGN(newsize, RT_ALIGN_SIZE);
+    if (newsize > 0 && newsize < MIN_BLOCK_SIZE)
+        newsize = MIN_BLOCK_SIZE;
     if (newsize > small_mem->mem_size_aligned)
     {
         RT_DEBUG_LOG(RT_DEBUG_MEM, ("realloc: out of memory\n"));
+        SMEM_TRACE(small_mem, RT_SMEM_TRACE_REALLOC, newsize, SMEM_TRACE_HANDLE(small_mem, rmem), 0);
 
         return RT_NULL;
     }
@@ -442,55 +2230,53 @@ void *rt_smem_realloc(rt_smem_t m, void *rmem, rt_size_t newsize)
     if (rmem == RT_NULL)
         return rt_smem_alloc(&small_mem->parent, newsize);
 
-    RT_ASSERT((((rt_ubase_t)rmem) & (RT_ALIGN_SIZE - 1)) == 0);
-    RT_ASSERT((rt_uint8_t *)rmem >= (rt_uint8_t *)small_mem->heap_ptr);
-    RT_ASSERT((rt_uint8_t *)rmem < (rt_uint8_t *)small_mem->heap_end);
-
-    mem = (struct rt_small_mem_item *)((rt_uint8_t *)rmem - SIZEOF_STRUCT_MEM);
-
-    /* current memory block size */
-    ptr = (rt_uint8_t *)mem - small_mem->heap_ptr;
-    size = mem->next - ptr - SIZEOF_STRUCT_MEM;
-    if (size == newsize)
-    {
-        /* the size is the same as */
-        return rmem;
-    }
-
-    if (newsize + SIZEOF_STRUCT_MEM + MIN_SIZE < size)
+#ifdef RT_USING_SMALL_MEM_GUARD
+    if (_smem_guard_find(rmem) == small_mem)
     {
-        /* split memory block */
-        small_mem->parent.used -= (size - newsize);
-
-        ptr2 = ptr + SIZEOF_STRUCT_MEM + newsize;
-        mem2 = (struct rt_small_mem_item *)&small_mem->heap_ptr[ptr2];
-        mem2->pool_ptr = MEM_FREED();
-        mem2->next = mem->next;
-        mem2->prev = ptr;
-        mem->next = ptr2;
-        if (mem2->next != small_mem->mem_size_aligned + SIZEOF_STRUCT_MEM)
-        {
-            ((struct rt_small_mem_item *)&small_mem->heap_ptr[mem2->next])->prev = ptr2;
-        }
+        struct rt_smem_guard_slot *slot;
 
-        if (mem2 < small_mem->lfree)
+        /* еĿƵͨ */
+        slot = &small_mem->guard_slot[((rt_uint8_t *)rmem - small_mem->guard_area) / SMEM_GUARD_SLOT_BYTES];
+        nmem = _smem_alloc(small_mem, newsize);
+        if (nmem != RT_NULL)
         {
-            /* the splited struct is now the lowest */
-            small_mem->lfree = mem2;
+            if (slot->used && slot->data == rmem)
+                rt_memcpy(nmem, rmem, slot->size < newsize ? slot->size : newsize);
+            SMEM_OWNER_TAKE(small_mem, nmem, RT_NULL);
+            _smem_guard_free(small_mem, rmem);
         }
+        SMEM_TRACE(small_mem, RT_SMEM_TRACE_REALLOC, newsize,
+                   SMEM_TRACE_HANDLE(small_mem, rmem), SMEM_TRACE_HANDLE(small_mem, nmem));
 
-        plug_holes(small_mem, mem2);
-
-        return rmem;
+        return nmem;
     }
+#endif /* RT_USING_SMALL_MEM_GUARD */
 
-    /* expand memory */
-    nmem = rt_smem_alloc(&small_mem->parent, newsize);
-    if (nmem != RT_NULL) /* check memory */
+#ifdef RT_USING_SMALL_MEM_OWNER
     {
-        rt_memcpy(nmem, rmem, size < newsize ? size : newsize);
-        rt_smem_free(rmem);
+        rt_base_t level;
+        rt_uint16_t index;
+        struct rt_small_mem_item *mem;
+
+        /* ĴСλÿܸı ȥ ɺǻԭ */
+        mem = (struct rt_small_mem_item *)((rt_uint8_t *)rmem - SIZEOF_STRUCT_MEM);
+        level = SMEM_OWNER_LOCK();
+        index = mem->owner;
+        _smem_owner_sub(small_mem, mem);
+        SMEM_OWNER_UNLOCK(level);
+
+        nmem = _smem_realloc(small_mem, rmem, newsize);
+
+        mem = (struct rt_small_mem_item *)((rt_uint8_t *)(nmem != RT_NULL ? nmem : rmem) - SIZEOF_STRUCT_MEM);
+        level = SMEM_OWNER_LOCK();
+        _smem_owner_add(small_mem, mem, index);
+        SMEM_OWNER_UNLOCK(level);
     }
+#else
+    nmem = _smem_realloc(small_mem, rmem, newsize);
+#endif /* RT_USING_SMALL_MEM_OWNER */
+    SMEM_TRACE(small_mem, RT_SMEM_TRACE_REALLOC, newsize,
+               SMEM_TRACE_HANDLE(small_mem, rmem), SMEM_TRACE_HANDLE(small_mem, nmem));
 
     return nmem;
 }
@@ -515,6 +2301,17 @@ void rt_smem_free(void *rmem)
 
     RT_ASSERT((((rt_ubase_t)rmem) & (RT_ALIGN_SIZE - 1)) == 0);
 
+#ifdef RT_USING_SMALL_MEM_GUARD
+    /* еĿûͷ */
+    small_mem = _smem_guard_find(rmem);
+    if (small_mem != RT_NULL)
+    {
+        SMEM_TRACE(small_mem, RT_SMEM_TRACE_FREE, 0, SMEM_TRACE_HANDLE(small_mem, rmem), 0);
+        _smem_guard_free(small_mem, rmem);
+        return;
+    }
+#endif /* RT_USING_SMALL_MEM_GUARD */
+
     /* Get the corresponding struct rt_small_mem_item ... */
     mem = (struct rt_small_mem_item *)((rt_uint8_t *)rmem - SIZEOF_STRUCT_MEM);
     /* ... which has to be in a used state ... */
@@ -532,24 +2329,431 @@ void rt_smem_free(void *rmem)
                   (rt_ubase_t)rmem,
                   (rt_ubase_t)(mem->next - ((rt_uint8_t *)mem - small_mem->heap_ptr))));
 
-    /* ... and is now unused. */
-    mem->pool_ptr = MEM_FREED();
+    SMEM_TRACE(small_mem, RT_SMEM_TRACE_FREE, 0, SMEM_TRACE_HANDLE(small_mem, rmem), 0);
+    SMEM_OWNER_GIVE(small_mem, rmem);
+    _smem_free(small_mem, mem);
+}
+RTM_EXPORT(rt_smem_free);
+
+/**
+ * @brief This function will reset a walker to the first block of the heap.
+ *
+ * @param walker the walker to be reset.
+ */
+void rt_smem_walk_init(struct rt_smem_walker *walker)
+{
+    RT_ASSERT(walker != RT_NULL);
+
+    walker->offset  = 0;
+    walker->version = 0;
+}
+RTM_EXPORT(rt_smem_walk_init);
+
+/* ƫǷȻһЧͷ */
+static rt_bool_t _smem_walk_valid(struct rt_small_mem *small_mem, rt_size_t offset)
+{
+    struct rt_small_mem_item *mem;
+
+    /* ѵʼλúͽλЧ */
+    if (offset == 0 || offset == small_mem->mem_size_aligned + SIZEOF_STRUCT_MEM)
+        return RT_TRUE;
+    if (offset > small_mem->mem_size_aligned || offset % RT_ALIGN_SIZE)
+        return RT_FALSE;
+
+    mem = (struct rt_small_mem_item *)&small_mem->heap_ptr[offset];
+    /* ϲͷpool_ptr ǰҲָ */
+    if (MEM_POOL(mem) != small_mem)
+        return RT_FALSE;
+    if (mem->prev >= offset || mem->next <= offset ||
+        mem->next > small_mem->mem_size_aligned + SIZEOF_STRUCT_MEM)
+        return RT_FALSE;
+    if (((struct rt_small_mem_item *)&small_mem->heap_ptr[mem->prev])->next != offset)
+        return RT_FALSE;
+
+    return RT_TRUE;
+}
+
+/**
+ * @brief This function will report the next block of the heap. It only looks at one
+ *        block, so the heap lock can be released between two calls.
+ *
+ * @param m the small memory management object.
+ *
+ * @param walker the walker, initialized by rt_smem_walk_init.
+ *
+ * @param block the reported block.
+ *
+ * @return RT_EOK: one block is reported.
+ *         -RT_EEMPTY: all blocks have been visited.
+ *         -RT_EBUSY: the heap changed and the walker position is lost, the walker
+ *                    is rewound to the first block.
+ */
+rt_err_t rt_smem_walk(rt_smem_t m, struct rt_smem_walker *walker, struct rt_smem_block *block)
+{
+    struct rt_small_mem *small_mem;
+    struct rt_small_mem_item *mem;
+
+    RT_ASSERT(m != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&m->parent) == RT_Object_Class_Memory);
+    RT_ASSERT(walker != RT_NULL);
+    RT_ASSERT(block != RT_NULL);
+
+    small_mem = (struct rt_small_mem *)m;
 
-    if (mem < small_mem->lfree)
+    /* ѽṹ仯 ҪȷϵλȻһͷ */
+    if (walker->version != small_mem->version)
     {
-        /* the newly freed struct is now the lowest */
-        small_mem->lfree = mem;
+        if (!_smem_walk_valid(small_mem, walker->offset))
+        {
+            walker->offset  = 0;
+            walker->version = small_mem->version;
+            return -RT_EBUSY;
+        }
+        walker->version = small_mem->version;
     }
 
-    small_mem->parent.used -= (mem->next - ((rt_uint8_t *)mem - small_mem->heap_ptr));
+    mem = (struct rt_small_mem_item *)&small_mem->heap_ptr[walker->offset];
+    if (mem == small_mem->heap_end)
+        return -RT_EEMPTY;
 
-    /* finally, see if prev or next are free also */
-    plug_holes(small_mem, mem);
+    block->addr = (rt_uint8_t *)mem + SIZEOF_STRUCT_MEM;
+    block->size = MEM_SIZE(small_mem, mem);
+    block->used = MEM_ISUSED(mem) ? RT_TRUE : RT_FALSE;
+
+    walker->offset = mem->next;
+
+    return RT_EOK;
 }
-RTM_EXPORT(rt_smem_free);
+RTM_EXPORT(rt_smem_walk);
+
+/**
+ * @brief This function will reset a fragmentation summary.
+ *
+ * @param stat the summary to be reset.
+ */
+void rt_smem_stat_init(struct rt_smem_stat *stat)
+{
+    RT_ASSERT(stat != RT_NULL);
+
+    rt_memset(stat, 0, sizeof(struct rt_smem_stat));
+    rt_smem_walk_init(&stat->walker);
+}
+RTM_EXPORT(rt_smem_stat_init);
+
+/**
+ * @brief This function will visit at most 'budget' blocks and accumulate them into
+ *        the fragmentation summary. Call it repeatedly, with the heap lock held only
+ *        during each call, until it returns RT_EOK.
+ *
+ * @param m the small memory management object.
+ *
+ * @param stat the summary, initialized by rt_smem_stat_init.
+ *
+ * @param budget the maximum number of blocks visited in this step.
+ *
+ * @return RT_EOK: the summary is complete.
+ *         -RT_EBUSY: more steps are needed. If the heap keeps changing, the walk
+ *                    restarts and stat->restart counts how many times, so the
+ *                    caller can give up.
+ */
+rt_err_t rt_smem_stat_step(rt_smem_t m, struct rt_smem_stat *stat, rt_size_t budget)
+{
+    rt_err_t result;
+    struct rt_smem_block block;
+
+    RT_ASSERT(stat != RT_NULL);
+
+    while (budget --)
+    {
+        result = rt_smem_walk(m, &stat->walker, &block);
+        if (result == -RT_EEMPTY)
+        {
+            /* Ƭָ: пռȫڴıԽС ƬԽ */
+            if (stat->free_total)
+                stat->frag_index = (rt_uint8_t)(100 - (stat->largest_free * 100) / stat->free_total);
+            return RT_EOK;
+        }
+        if (result == -RT_EBUSY)
+        {
+            rt_uint16_t restart = stat->restart;
+
+            /* λöʧ ͳƵĽ ͷʼ */
+            rt_smem_stat_init(stat);
+            stat->restart = restart + 1;
+            continue;
+        }
+
+        if (block.used)
+        {
+            stat->used_blocks ++;
+            stat->used_hist[_smem_bin_index(block.size)] ++;
+        }
+        else
+        {
+            stat->free_blocks ++;
+            stat->free_total += block.size;
+            stat->free_hist[_smem_bin_index(block.size)] ++;
+            if (block.size > stat->largest_free)
+                stat->largest_free = block.size;
+        }
+    }
+
+    return -RT_EBUSY;
+}
+RTM_EXPORT(rt_smem_stat_step);
 
 #ifdef RT_USING_FINSH
 #include <finsh.h>
+
+/* ͳƹжһֱڱ仯 ¿ʼĴֵͷ */
+#ifndef RT_SMALL_MEM_STAT_RESTART
+#define RT_SMALL_MEM_STAT_RESTART       8
+#endif
+
+/* ӡСڴѵƬͳ */
+static int list_smem_frag(void)
+{
+    int index;
+    struct rt_list_node *node;
+    struct rt_object_information *information;
+    struct rt_smem_stat stat;
+    struct rt_memory *m;
+
+    information = rt_object_get_information(RT_Object_Class_Memory);
+    if (information == RT_NULL)
+        return -RT_ERROR;
+
+    rt_list_for_each(node, &(information->object_list))
+    {
+        m = (struct rt_memory *)rt_list_entry(node, struct rt_object, list);
+        if (rt_strncmp(m->algorithm, "small", 5) != 0)
+            continue;
+
+        rt_smem_stat_init(&stat);
+        while (1)
+        {
+            rt_err_t result;
+
+            /* ÿֻĿ жѵע(rt_mallocĶ) 벽֮ */
+            _smem_lock((struct rt_small_mem *)m, RT_WAITING_FOREVER);
+            result = rt_smem_stat_step(m, &stat, 32);
+            _smem_unlock((struct rt_small_mem *)m);
+            if (result == RT_EOK || stat.restart > RT_SMALL_MEM_STAT_RESTART)
+                break;
+        }
+        if (stat.restart > RT_SMALL_MEM_STAT_RESTART)
+        {
+            rt_kprintf("%-*.*s incomplete, heap changed %d times during the walk\n",
+                       RT_NAME_MAX, RT_NAME_MAX, rt_object_get_name(&(m->parent)), stat.restart);
+            continue;
+        }
+
+        rt_kprintf("%-*.*s free %d in %d blocks, largest %d, used %d blocks, fragmentation %d%%\n",
+                   RT_NAME_MAX, RT_NAME_MAX, rt_object_get_name(&(m->parent)),
+                   stat.free_total, stat.free_blocks, stat.largest_free,
+                   stat.used_blocks, stat.frag_index);
+        rt_kprintf("  realloc in place %d, moved %d\n",
+                   ((struct rt_small_mem *)m)->realloc_inplace,
+                   ((struct rt_small_mem *)m)->realloc_moved);
+#ifdef RT_USING_SMALL_MEM_DEFER
+        rt_kprintf("  deferred %d, max %d, alloc retried %d\n",
+                   ((struct rt_small_mem *)m)->defer_count,
+                   ((struct rt_small_mem *)m)->defer_max,
+                   ((struct rt_small_mem *)m)->defer_retry);
+#endif /* RT_USING_SMALL_MEM_DEFER */
+        rt_kprintf("  class   free   used\n");
+        for (index = 0; index < RT_SMALL_MEM_BIN_NR; index ++)
+        {
+            if (stat.free_hist[index] == 0 && stat.used_hist[index] == 0)
+                continue;
+            rt_kprintf("  >=%-5d %-6d %-6d\n",
+                       index ? (1 << (index + SMEM_BIN_SHIFT)) : 0,
+                       stat.free_hist[index], stat.used_hist[index]);
+        }
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT(list_smem_frag, show small memory fragmentation);
+
+#ifdef RT_USING_SMALL_MEM_OWNER
+/* ӡСڴиڴʹ */
+static int list_smem_owner(void)
+{
+    int index;
+    rt_base_t level;
+    struct rt_list_node *node;
+    struct rt_object_information *information;
+    struct rt_smem_owner owner;
+    struct rt_memory *m;
+
+    information = rt_object_get_information(RT_Object_Class_Memory);
+    if (information == RT_NULL)
+        return -RT_ERROR;
+
+    rt_list_for_each(node, &(information->object_list))
+    {
+        m = (struct rt_memory *)rt_list_entry(node, struct rt_object, list);
+        if (rt_strncmp(m->algorithm, "small", 5) != 0)
+            continue;
+
+        rt_kprintf("%-*.*s used %d\n", RT_NAME_MAX, RT_NAME_MAX, rt_object_get_name(&(m->parent)), m->used);
+        rt_kprintf("  %-*.*s bytes    blocks   max\n", RT_NAME_MAX, RT_NAME_MAX, "owner");
+        for (index = 0; index < RT_SMALL_MEM_OWNER_NR; index ++)
+        {
+            /*  ӡʱʱж */
+            level = rt_hw_interrupt_disable();
+            owner = ((struct rt_small_mem *)m)->owner[index];
+            rt_hw_interrupt_enable(level);
+
+            if (owner.max == 0)
+                continue;
+            rt_kprintf("  %-*.*s %-8d %-8d %-8d\n", RT_NAME_MAX, RT_NAME_MAX, owner.name,
+                       owner.bytes, owner.blocks, owner.max);
+        }
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT(list_smem_owner, show small memory usage of each thread or tag);
+#endif /* RT_USING_SMALL_MEM_OWNER */
+
+#ifdef RT_USING_SMALL_MEM_GUARD
+/* 鲢ӡСڴѵı */
+static int list_smem_guard(void)
+{
+    int index;
+    struct rt_small_mem *small_mem;
+    struct rt_smem_guard_slot *slot;
+
+    for (small_mem = _smem_guard_list; small_mem != RT_NULL; small_mem = small_mem->guard_next)
+    {
+        _smem_lock(small_mem, RT_WAITING_FOREVER);
+        rt_smem_guard_check(&small_mem->parent);
+        _smem_unlock(small_mem);
+
+        rt_kprintf("%-*.*s rate %d, sampled %d, errors %d\n",
+                   RT_NAME_MAX, RT_NAME_MAX, rt_object_get_name(&(small_mem->parent.parent)),
+                   small_mem->guard_rate, small_mem->guard_sampled, small_mem->guard_errors);
+        for (index = 0; index < RT_SMALL_MEM_GUARD_SLOT_NR; index ++)
+        {
+            slot = &small_mem->guard_slot[index];
+            if (slot->data == RT_NULL)
+                continue;
+            rt_kprintf("  slot %-2d 0x%08x %-4d %s by %.*s\n", index, (rt_ubase_t)slot->data, slot->size,
+                       slot->used ? "used    " : "released", RT_NAME_MAX,
+                       slot->used ? slot->alloc_name : slot->free_name);
+        }
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT(list_smem_guard, check and show guarded slots of small memory);
+#endif /* RT_USING_SMALL_MEM_GUARD */
+
+#ifdef RT_USING_SMALL_MEM_TRACE
+#include <stdlib.h>
+
+/* һļ¼ */
+#ifndef RT_SMALL_MEM_TRACE_CMD_MAX
+#define RT_SMALL_MEM_TRACE_CMD_MAX      4096
+#endif
+
+/* ļ¼ʹõĻ ͬһʱֻ֧һ */
+static struct rt_smem_trace_record *_smem_trace_cmd_buf = RT_NULL;
+static rt_smem_t _smem_trace_cmd_heap = RT_NULL;
+
+static void _smem_trace_usage(void)
+{
+    rt_kprintf("Usage: smem_trace <heap> start <records> | dump | stop\n");
+    rt_kprintf("  records: 1 .. %d, default 256\n", RT_SMALL_MEM_TRACE_CMD_MAX);
+}
+
+/* ıʽ¼ ÿһ ڴӴ־ȡ߻ط */
+static void _smem_trace_dump(rt_smem_t m)
+{
+    struct rt_smem_trace_record record;
+    const char ops[] = "?arfA";
+
+    while (rt_smem_trace_read(m, &record, 1) == 1)
+    {
+        rt_kprintf("smem %u %c %u %u %u\n", record.timestamp,
+                   ops[(record.op_size >> 24) < sizeof(ops) - 1 ? (record.op_size >> 24) : 0],
+                   record.op_size & SMEM_TRACE_SIZE_MASK, record.handle, record.result);
+    }
+}
+
+static int smem_trace(int argc, char **argv)
+{
+    int count;
+    rt_object_t object;
+
+    if (argc < 3 || (rt_strcmp(argv[2], "start") != 0 &&
+                     rt_strcmp(argv[2], "dump") != 0 &&
+                     rt_strcmp(argv[2], "stop") != 0))
+    {
+        _smem_trace_usage();
+        return -RT_ERROR;
+    }
+
+    object = rt_object_find(argv[1], RT_Object_Class_Memory);
+    if (object == RT_NULL)
+    {
+        rt_kprintf("no heap named %s\n", argv[1]);
+        return -RT_ERROR;
+    }
+
+    if (rt_strcmp(argv[2], "start") == 0)
+    {
+        if (_smem_trace_cmd_buf != RT_NULL)
+        {
+            rt_kprintf("trace of %s is running\n", rt_object_get_name(&(_smem_trace_cmd_heap->parent)));
+            return -RT_EBUSY;
+        }
+        count = argc > 3 ? atoi(argv[3]) : 256;
+        if (count <= 0 || count > RT_SMALL_MEM_TRACE_CMD_MAX)
+        {
+            _smem_trace_usage();
+            return -RT_EINVAL;
+        }
+        _smem_trace_cmd_buf = rt_malloc(count * sizeof(struct rt_smem_trace_record));
+        if (_smem_trace_cmd_buf == RT_NULL)
+        {
+            rt_kprintf("no memory for %d records\n", count);
+            return -RT_ENOMEM;
+        }
+        if (rt_smem_trace_start((rt_smem_t)object, _smem_trace_cmd_buf,
+                                count * sizeof(struct rt_smem_trace_record)) != RT_EOK)
+        {
+            rt_kprintf("start trace of %s failed\n", argv[1]);
+            rt_free(_smem_trace_cmd_buf);
+            _smem_trace_cmd_buf = RT_NULL;
+            return -RT_ERROR;
+        }
+        _smem_trace_cmd_heap = (rt_smem_t)object;
+    }
+    else if ((rt_smem_t)object != _smem_trace_cmd_heap)
+    {
+        rt_kprintf("trace of %s is not running\n", argv[1]);
+        return -RT_ERROR;
+    }
+    else if (rt_strcmp(argv[2], "dump") == 0)
+    {
+        _smem_trace_dump(_smem_trace_cmd_heap);
+    }
+    else if (rt_strcmp(argv[2], "stop") == 0)
+    {
+        _smem_trace_dump(_smem_trace_cmd_heap);
+        rt_kprintf("%u records lost\n", rt_smem_trace_stop(_smem_trace_cmd_heap));
+        rt_free(_smem_trace_cmd_buf);
+        _smem_trace_cmd_buf = RT_NULL;
+        _smem_trace_cmd_heap = RT_NULL;
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT(smem_trace, record small memory allocation trace);
+#endif /* RT_USING_SMALL_MEM_TRACE */
 #endif /* RT_USING_FINSH */
 
 #endif /* defined (RT_USING_SMALL_MEM) */
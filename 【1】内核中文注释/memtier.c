@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2006-2022, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * 分层堆
+ *
+ * 把几块速度和用途不同的内存(例如紧耦合RAM 可DMA的RAM 片外RAM)各自初始化成一个小内存堆
+ * 每个堆作为一层 带有属性 分配时按提示优先选择属性符合的层 不够时按顺序退到其他层
+ * 每层各有一把信号量 各层的分配互不影响
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#ifdef RT_USING_MEMTIER
+
+#ifndef RT_MEMTIER_MAX
+#define RT_MEMTIER_MAX                  4
+#endif
+
+/* 层的属性 同时也作为分配提示 */
+#define RT_MEMTIER_FAST                 0x01    /**< fast memory, e.g. tightly coupled RAM */
+#define RT_MEMTIER_DMA                  0x02    /**< DMA capable memory */
+#define RT_MEMTIER_BULK                 0x04    /**< large and slow memory, e.g. external RAM */
+/* 只有分配提示使用 不允许退到属性不符的层 */
+#define RT_MEMTIER_STRICT               0x100
+
+/**
+ * one tier of the tiered heap
+ */
+struct rt_memtier
+{
+    rt_smem_t                   heap;                   /**< small memory object of this tier */
+    rt_uint32_t                 attr;                   /**< RT_MEMTIER_FAST/DMA/BULK */
+    struct rt_semaphore         lock;                   /**< lock of the heap */
+
+    rt_size_t                   alloc_count;            /**< successful allocations */
+    rt_size_t                   fallback_count;         /**< allocations falling back to this tier */
+};
+
+/**
+ * usage of one tier
+ */
+struct rt_memtier_stat
+{
+    const char                 *name;                   /**< name of the tier */
+    rt_uint32_t                 attr;                   /**< attribute of the tier */
+    rt_size_t                   total;                  /**< memory size of the tier */
+    rt_size_t                   used;                   /**< used memory */
+    rt_size_t                   max;                    /**< maximum of used memory */
+    rt_size_t                   alloc_count;            /**< successful allocations */
+    rt_size_t                   fallback_count;         /**< allocations falling back to this tier */
+};
+
+/* 按注册顺序排列 应先注册速度快的层 */
+static struct rt_memtier _memtier[RT_MEMTIER_MAX];
+static rt_uint8_t _memtier_nr = 0;
+/* 所有层都分配失败的次数 */
+static rt_size_t _memtier_fail = 0;
+
+/**
+ * @brief This function will add a memory block to the tiered heap as a new tier.
+ *        Tiers shall be added from the fastest to the slowest.
+ *
+ * @param name the name of the tier.
+ *
+ * @param begin_addr the beginning address of the memory block.
+ *
+ * @param size the size of the memory block.
+ *
+ * @param attr the attribute of the tier, RT_MEMTIER_FAST, RT_MEMTIER_DMA or
+ *        RT_MEMTIER_BULK.
+ *
+ * @return the operation status, RT_EOK on successful, -RT_EFULL if there are
+ *         already RT_MEMTIER_MAX tiers.
+ */
+rt_err_t rt_memtier_add(const char *name, void *begin_addr, rt_size_t size, rt_uint32_t attr)
+{
+    struct rt_memtier *tier;
+
+    RT_DEBUG_NOT_IN_INTERRUPT;
+    RT_ASSERT(begin_addr != RT_NULL);
+
+    if (_memtier_nr >= RT_MEMTIER_MAX)
+        return -RT_EFULL;
+
+    tier = &_memtier[_memtier_nr];
+    tier->heap = rt_smem_init(name, begin_addr, size);
+    if (tier->heap == RT_NULL)
+        return -RT_ERROR;
+
+    tier->attr = attr & (RT_MEMTIER_FAST | RT_MEMTIER_DMA | RT_MEMTIER_BULK);
+    tier->alloc_count    = 0;
+    tier->fallback_count = 0;
+    rt_sem_init(&(tier->lock), name, 1, RT_IPC_FLAG_PRIO);
+    /* 空闲线程合并延迟释放的块时也要持有这个锁 */
+    rt_smem_set_lock(tier->heap, &(tier->lock.parent.parent));
+
+    /* 层初始化完成后才对分配可见 */
+    _memtier_nr ++;
+
+    return RT_EOK;
+}
+RTM_EXPORT(rt_memtier_add);
+
+/* 在一层中分配 */
+static void *_memtier_alloc(struct rt_memtier *tier, rt_size_t size, rt_bool_t fallback)
+{
+    void *ptr;
+
+    rt_sem_take(&(tier->lock), RT_WAITING_FOREVER);
+    ptr = rt_smem_alloc(tier->heap, size);
+    if (ptr != RT_NULL)
+    {
+        tier->alloc_count ++;
+        if (fallback)
+            tier->fallback_count ++;
+    }
+    rt_sem_release(&(tier->lock));
+
+    return ptr;
+}
+
+/**
+ * @brief This function will allocate a block from the tiered heap.
+ *
+ * @param size the size of memory to be allocated.
+ *
+ * @param hint the placement hint. The tiers having all the attributes in hint
+ *        are tried first. A DMA request never falls back to a tier without
+ *        RT_MEMTIER_DMA. With RT_MEMTIER_STRICT the allocation never falls back.
+ *        Tiers are tried from the fastest one, but from the slowest one with
+ *        RT_MEMTIER_BULK, so that bulk data leaves the fast memory alone.
+ *
+ * @return the allocated memory, RT_NULL on failure.
+ */
+void *rt_memtier_alloc(rt_size_t size, rt_uint32_t hint)
+{
+    int index, pass;
+    rt_uint32_t want, need;
+    struct rt_memtier *tier;
+    void *ptr;
+
+    RT_DEBUG_NOT_IN_INTERRUPT;
+
+    if (size == 0)
+        return RT_NULL;
+
+    want = hint & (RT_MEMTIER_FAST | RT_MEMTIER_DMA | RT_MEMTIER_BULK);
+    need = (hint & RT_MEMTIER_STRICT) ? want : (want & RT_MEMTIER_DMA);
+
+    /* 第一遍只试属性全部符合的层 第二遍退到满足必需属性的其他层 */
+    for (pass = 0; pass < 2; pass ++)
+    {
+        for (index = 0; index < _memtier_nr; index ++)
+        {
+            tier = (hint & RT_MEMTIER_BULK) ? &_memtier[_memtier_nr - 1 - index] : &_memtier[index];
+
+            if (pass == 0)
+            {
+                if ((tier->attr & want) != want)
+                    continue;
+            }
+            else
+            {
+                /* 第一遍已试过的层跳过 */
+                if ((tier->attr & want) == want || (tier->attr & need) != need)
+                    continue;
+            }
+
+            ptr = _memtier_alloc(tier, size, pass == 1);
+            if (ptr != RT_NULL)
+                return ptr;
+        }
+
+        if (need == want)
+            break;
+    }
+
+    _memtier_fail ++;
+
+    return RT_NULL;
+}
+RTM_EXPORT(rt_memtier_alloc);
+
+/* 找到内存块所在的层 */
+static struct rt_memtier *_memtier_find(void *ptr)
+{
+    int index;
+    struct rt_memtier *tier;
+
+    for (index = 0; index < _memtier_nr; index ++)
+    {
+        tier = &_memtier[index];
+        if ((rt_ubase_t)ptr >= (rt_ubase_t)tier->heap->address &&
+            (rt_ubase_t)ptr <  (rt_ubase_t)tier->heap->address + tier->heap->total)
+            return tier;
+    }
+
+    return RT_NULL;
+}
+
+/**
+ * @brief This function will release a block allocated by rt_memtier_alloc.
+ *
+ * @param ptr the block to be released.
+ */
+void rt_memtier_free(void *ptr)
+{
+    struct rt_memtier *tier;
+
+    RT_DEBUG_NOT_IN_INTERRUPT;
+
+    if (ptr == RT_NULL)
+        return;
+
+    tier = _memtier_find(ptr);
+    RT_ASSERT(tier != RT_NULL);
+
+    rt_sem_take(&(tier->lock), RT_WAITING_FOREVER);
+    rt_smem_free(ptr);
+    rt_sem_release(&(tier->lock));
+}
+RTM_EXPORT(rt_memtier_free);
+
+/**
+ * @brief This function will get the usage of one tier.
+ *
+ * @param index the index of the tier, in the order of rt_memtier_add.
+ *
+ * @param stat the usage of the tier.
+ *
+ * @return the operation status, RT_EOK on successful, -RT_ERROR if there is
+ *         no such tier.
+ */
+rt_err_t rt_memtier_info(int index, struct rt_memtier_stat *stat)
+{
+    struct rt_memtier *tier;
+
+    RT_ASSERT(stat != RT_NULL);
+
+    if (index < 0 || index >= _memtier_nr)
+        return -RT_ERROR;
+
+    tier = &_memtier[index];
+    rt_sem_take(&(tier->lock), RT_WAITING_FOREVER);
+    stat->name           = rt_object_get_name(&(tier->heap->parent));
+    stat->attr           = tier->attr;
+    stat->total          = tier->heap->total;
+    stat->used           = tier->heap->used;
+    stat->max            = tier->heap->max;
+    stat->alloc_count    = tier->alloc_count;
+    stat->fallback_count = tier->fallback_count;
+    rt_sem_release(&(tier->lock));
+
+    return RT_EOK;
+}
+RTM_EXPORT(rt_memtier_info);
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+
+/* 打印各层的使用情况 */
+static int list_memtier(void)
+{
+    int index;
+    struct rt_memtier_stat stat;
+
+    rt_kprintf("%-*.*s attr  total    used     max      alloc    fallback\n",
+               RT_NAME_MAX, RT_NAME_MAX, "tier");
+    for (index = 0; rt_memtier_info(index, &stat) == RT_EOK; index ++)
+    {
+        rt_kprintf("%-*.*s %c%c%c   %-8d %-8d %-8d %-8d %-8d\n",
+                   RT_NAME_MAX, RT_NAME_MAX, stat.name,
+                   (stat.attr & RT_MEMTIER_FAST) ? 'f' : '-',
+                   (stat.attr & RT_MEMTIER_DMA)  ? 'd' : '-',
+                   (stat.attr & RT_MEMTIER_BULK) ? 'b' : '-',
+                   stat.total, stat.used, stat.max,
+                   stat.alloc_count, stat.fallback_count);
+    }
+    rt_kprintf("failed: %d\n", _memtier_fail);
+
+    return 0;
+}
+MSH_CMD_EXPORT(list_memtier, show tiered heap usage);
+#endif /* RT_USING_FINSH */
+
+#endif /* RT_USING_MEMTIER */
@@ -102,6 +102,428 @@ static struct rt_object_information rt_object_container[RT_Object_Info_Unknown]
 #endif
 };
 
+#ifdef RT_USING_OBJECT_NAME_TABLE
+#ifndef RT_OBJECT_NAME_TABLE_SIZE
+#define RT_OBJECT_NAME_TABLE_SIZE   64
+#endif
+#if (RT_OBJECT_NAME_TABLE_SIZE & (RT_OBJECT_NAME_TABLE_SIZE - 1)) != 0 || RT_OBJECT_NAME_TABLE_SIZE > 0x10000
+#error "RT_OBJECT_NAME_TABLE_SIZE must be a power of 2 and not larger than 65536"
+#endif
+
+/*
+ * one entry of the name table
+ */
+/*
+ * 名字表项 对象中只保存表项的下标name_id 同名的对象共用一个表项
+ * 名字表是线性探测的散列表 ref为0而名字不为空的表项是墓碑 查找时要越过它
+ * 下标0固定表示空名字 表满时对象也得到空名字
+ */
+struct rt_object_name_entry
+{
+    char        name[RT_NAME_MAX];      /**< the name */
+    rt_uint16_t ref;                    /**< number of objects using the name */
+};
+
+static struct rt_object_name_entry _object_name[RT_OBJECT_NAME_TABLE_SIZE];
+/* 正在使用的表项数 和因表满而失去名字的次数 */
+static rt_uint16_t _object_name_used = 0;
+static rt_uint32_t _object_name_lost = 0;
+
+#define _OBJ_NAME(object)           ((const char *)_object_name[(object)->name_id].name)
+#define _OBJ_NAME_EMPTY(index)      ((index) != 0 && _object_name[index].ref == 0 && _object_name[index].name[0] == '\0')
+#define _OBJ_NAME_NEXT(index)       (((index) + 1) & (RT_OBJECT_NAME_TABLE_SIZE - 1))
+/* 查找名字和遍历对象不在同一个关中断区间 其间表项可能被释放后分配给别的名字 name_id相同时再比较名字 */
+#define _OBJ_NAME_MATCH(object, obj_name, id) \
+    ((object)->name_id == (id) && rt_strncmp(_OBJ_NAME(object), (obj_name), RT_NAME_MAX) == 0)
+
+rt_inline rt_uint32_t _object_name_hash(const char *name)
+{
+    int index;
+    rt_uint32_t hash = 2166136261u;
+
+    for (index = 0; index < RT_NAME_MAX && name[index] != '\0'; index ++)
+    {
+        hash = (hash ^ (rt_uint8_t)name[index]) * 16777619u;
+    }
+
+    return (hash ^ (hash >> 16)) & (RT_OBJECT_NAME_TABLE_SIZE - 1);
+}
+
+/*
+ * 查找名字 找到时返回表项下标 否则返回0
+ * 找不到时free_index返回可用的表项(第一个墓碑或探测结束处的空表项) 没有可用表项时为0
+ * 需关中断调用
+ */
+static rt_uint32_t _object_name_lookup(const char *name, rt_uint32_t *free_index)
+{
+    rt_uint32_t index, count, avail = 0;
+    struct rt_object_name_entry *entry;
+
+    index = _object_name_hash(name);
+    for (count = 0; count < RT_OBJECT_NAME_TABLE_SIZE; count ++, index = _OBJ_NAME_NEXT(index))
+    {
+        if (index == 0)
+            continue;
+
+        entry = &_object_name[index];
+        if (entry->ref == 0)
+        {
+            if (avail == 0)
+                avail = index;
+            /* 空表项是探测链的结尾 */
+            if (entry->name[0] == '\0')
+                break;
+        }
+        else if (rt_strncmp(entry->name, name, RT_NAME_MAX) == 0)
+        {
+            return index;
+        }
+    }
+
+    if (free_index != RT_NULL)
+        *free_index = avail;
+
+    return 0;
+}
+
+/* 取得名字的表项并增加引用 */
+static rt_uint16_t _object_name_get(const char *name)
+{
+    register rt_base_t temp;
+    rt_uint32_t index, avail;
+
+    if (name == RT_NULL || name[0] == '\0')
+        return 0;
+
+    temp = rt_hw_interrupt_disable();
+    index = _object_name_lookup(name, &avail);
+    if (index == 0)
+    {
+        if (avail == 0)
+        {
+            _object_name_lost ++;
+            rt_hw_interrupt_enable(temp);
+            return 0;
+        }
+
+        index = avail;
+        rt_strncpy(_object_name[index].name, name, RT_NAME_MAX);
+        _object_name_used ++;
+    }
+    RT_ASSERT(_object_name[index].ref < 0xffff);
+    _object_name[index].ref ++;
+    rt_hw_interrupt_enable(temp);
+
+    return (rt_uint16_t)index;
+}
+
+/* 减少名字的引用 引用为0的表项变成墓碑 后面是空表项时连同前面的墓碑一起清空 需关中断调用 */
+static void _object_name_put(rt_uint16_t name_id)
+{
+    rt_uint32_t index = name_id;
+
+    if (index == 0)
+        return;
+
+    RT_ASSERT(_object_name[index].ref > 0);
+    if (-- _object_name[index].ref != 0)
+        return;
+
+    _object_name_used --;
+    while (index != 0 && _object_name[index].ref == 0 && _object_name[index].name[0] != '\0' &&
+           _OBJ_NAME_EMPTY(_OBJ_NAME_NEXT(index)))
+    {
+        _object_name[index].name[0] = '\0';
+        index = (index - 1) & (RT_OBJECT_NAME_TABLE_SIZE - 1);
+    }
+}
+#else
+#define _OBJ_NAME(object)           ((const char *)(object)->name)
+#endif /* RT_USING_OBJECT_NAME_TABLE */
+
+#ifdef RT_USING_OBJECT_HASH
+#ifndef RT_OBJECT_HASH_SIZE
+#define RT_OBJECT_HASH_SIZE     64
+#endif
+#if (RT_OBJECT_HASH_SIZE & (RT_OBJECT_HASH_SIZE - 1)) != 0
+#error "RT_OBJECT_HASH_SIZE must be a power of 2"
+#endif
+
+/*
+ * the name index of all objects, hashed by object type and name.
+ */
+/* 按对象类型和名字散列的索引 同一桶中的对象通过hash_next链接 新对象在桶头 */
+static struct rt_object *_object_hash[RT_OBJECT_HASH_SIZE];
+
+/* 计算桶的下标 名字最多取前RT_NAME_MAX个字符 与rt_strncmp的比较范围一致 */
+rt_inline rt_uint32_t _object_hash_index(const char *name, rt_uint8_t type)
+{
+    int index;
+    rt_uint32_t hash = 2166136261u ^ type;
+
+    for (index = 0; index < RT_NAME_MAX && name[index] != '\0'; index ++)
+    {
+        hash = (hash ^ (rt_uint8_t)name[index]) * 16777619u;
+    }
+
+    return (hash ^ (hash >> 16)) & (RT_OBJECT_HASH_SIZE - 1);
+}
+
+/* 加入索引 需关中断调用 */
+static void _object_hash_insert(struct rt_object *object, rt_uint8_t type)
+{
+    struct rt_object **bucket;
+
+    bucket = &_object_hash[_object_hash_index(_OBJ_NAME(object), type)];
+    object->hash_next = *bucket;
+    *bucket = object;
+}
+
+/* 从索引中移除 对象不在索引中时什么也不做 需关中断调用 */
+static void _object_hash_remove(struct rt_object *object, rt_uint8_t type)
+{
+    struct rt_object **node;
+
+    for (node = &_object_hash[_object_hash_index(_OBJ_NAME(object), type)];
+            *node != RT_NULL;
+            node = &((*node)->hash_next))
+    {
+        if (*node == object)
+        {
+            *node = object->hash_next;
+            object->hash_next = RT_NULL;
+            break;
+        }
+    }
+}
+#endif /* RT_USING_OBJECT_HASH */
+
+#ifdef RT_USING_OBJECT_HANDLE
+#ifndef RT_OBJECT_HANDLE_MAX
+#define RT_OBJECT_HANDLE_MAX    256
+#endif
+#if RT_OBJECT_HANDLE_MAX > 0xffff
+#error "RT_OBJECT_HANDLE_MAX must be less than 65536"
+#endif
+
+/* 句柄: 高16位是代数 低16位是句柄表下标 代数从1开始 所以句柄不会为0 */
+#define _OBJ_HANDLE(index, generation)  (((rt_uint32_t)(generation) << 16) | (index))
+#define _OBJ_HANDLE_INDEX(handle)       ((handle) & 0xffff)
+#define _OBJ_HANDLE_GENERATION(handle)  ((handle) >> 16)
+#define _OBJ_HANDLE_NONE                0xffff
+
+/*
+ * one entry of the handle table
+ */
+/* 句柄表项 表项每次释放代数加1 之前发出的句柄随即失效 */
+struct rt_object_handle_entry
+{
+    struct rt_object *object;                   /**< the object, RT_NULL if free */
+    rt_uint16_t       generation;               /**< generation of the entry */
+    rt_uint16_t       next_free;                /**< next entry in the free queue */
+};
+
+static struct rt_object_handle_entry _object_handle[RT_OBJECT_HANDLE_MAX];
+/* 空闲表项按先进先出重用 使同一表项的代数尽量慢地回绕 */
+static rt_uint16_t _object_handle_free_head = _OBJ_HANDLE_NONE;
+static rt_uint16_t _object_handle_free_tail = _OBJ_HANDLE_NONE;
+/* 从未使用过的表项从这里开始 也是遍历的上限 */
+static rt_uint32_t _object_handle_top = 0;
+
+/* 为对象分配句柄 句柄表已满时对象没有句柄 需关中断调用 */
+static void _object_handle_alloc(struct rt_object *object)
+{
+    rt_uint32_t index;
+    struct rt_object_handle_entry *entry;
+
+    if (_object_handle_free_head != _OBJ_HANDLE_NONE)
+    {
+        index = _object_handle_free_head;
+        _object_handle_free_head = _object_handle[index].next_free;
+        if (_object_handle_free_head == _OBJ_HANDLE_NONE)
+            _object_handle_free_tail = _OBJ_HANDLE_NONE;
+    }
+    else if (_object_handle_top < RT_OBJECT_HANDLE_MAX)
+    {
+        index = _object_handle_top ++;
+        _object_handle[index].generation = 1;
+    }
+    else
+    {
+        object->handle = 0;
+        return;
+    }
+
+    entry = &_object_handle[index];
+    entry->object  = object;
+    object->handle = _OBJ_HANDLE(index, entry->generation);
+}
+
+/* 释放对象的句柄 对象没有句柄时什么也不做 需关中断调用 */
+static void _object_handle_free(struct rt_object *object)
+{
+    rt_uint32_t index;
+    struct rt_object_handle_entry *entry;
+
+    if (object->handle == 0)
+        return;
+
+    index = _OBJ_HANDLE_INDEX(object->handle);
+    entry = &_object_handle[index];
+    RT_ASSERT(entry->object == object);
+
+    entry->object = RT_NULL;
+    /* 代数跳过0 */
+    entry->generation = (entry->generation == 0xffff) ? 1 : entry->generation + 1;
+    entry->next_free  = _OBJ_HANDLE_NONE;
+    if (_object_handle_free_tail == _OBJ_HANDLE_NONE)
+        _object_handle_free_head = (rt_uint16_t)index;
+    else
+        _object_handle[_object_handle_free_tail].next_free = (rt_uint16_t)index;
+    _object_handle_free_tail = (rt_uint16_t)index;
+
+    object->handle = 0;
+}
+#endif /* RT_USING_OBJECT_HANDLE */
+
+#ifndef RT_OBJECT_WALK_CHUNK
+#define RT_OBJECT_WALK_CHUNK    16
+#endif
+#ifndef RT_OBJECT_WALK_RETRY
+#define RT_OBJECT_WALK_RETRY    4
+#endif
+
+/* 每类对象链表的版本号 下标与rt_object_container一致 链表每次插入或移除时加1 */
+static rt_uint32_t _object_list_version[RT_Object_Info_Unknown];
+
+/* 对象链表发生了变化 需关中断调用 */
+static void _object_list_changed(rt_uint8_t type)
+{
+    int index;
+
+    for (index = 0; index < RT_Object_Info_Unknown; index ++)
+    {
+        if (rt_object_container[index].type == type)
+        {
+            _object_list_version[index] ++;
+            break;
+        }
+    }
+}
+
+#ifdef RT_USING_OBJECT_REGISTRY
+#ifdef RT_USING_OBJECT_NAME_TABLE
+#error "the static object registry can't be used with RT_USING_OBJECT_NAME_TABLE"
+#endif
+
+/*
+ * 静态对象注册表
+ *
+ * 静态定义并已初始化好的对象 通过RT_OBJECT_EXPORT把描述符的指针放到段.rt_obj.<类型>.<名字>中
+ * 链接脚本按段名排序(GCC: KEEP(*(SORT(.rt_obj.*))))后 指针按类型和名字有序
+ * 段中只放指针 不放描述符本身 编译器可能把较大的结构体对齐到比其大小更大的边界 使段中出现空隙
+ * 启动时不需要注册 查找时用二分查找 这些对象不在对象容器的链表中
+ * 对象被rt_object_detach后类型为0 注册表跳过它 之后可以再用rt_object_init动态初始化
+ * 这时对象在容器的链表中 注册表同样跳过它 注册表中的名字(即RT_OBJECT_EXPORT的name)应与对象的名字相同
+ *
+ * 类型用两位小写十六进制数表示 使段名的顺序与类型的数值顺序一致 例如设备:
+ *
+ *   static struct rt_device uart1 = {RT_OBJECT_STATIC_INIT(uart1.parent, "uart1", RT_Object_Class_Device), ...};
+ *   RT_OBJECT_EXPORT(uart1.parent, uart1, 09);
+ */
+
+/**
+ * descriptor of a statically registered object
+ */
+struct rt_object_desc
+{
+    const char         *name;                   /**< name, the sorting key */
+    struct rt_object   *object;                 /**< the object */
+    rt_uint8_t          type;                   /**< type of object */
+};
+
+#ifndef RT_OBJECT_EXPORT
+#define RT_OBJECT_STATIC_INIT(object, obj_name, obj_type)                   \
+    {.name = obj_name, .type = (obj_type) | RT_Object_Class_Static, .list = {&((object).list), &((object).list)}}
+
+#define RT_OBJECT_EXPORT(object, name, type_hex)                            \
+    static const struct rt_object_desc __rt_obj_desc_##name =               \
+        {#name, &(object), 0x##type_hex};                                   \
+    RT_USED static const struct rt_object_desc *const __rt_obj_##name       \
+    RT_SECTION(".rt_obj." #type_hex "." #name) = &__rt_obj_desc_##name
+#endif /* RT_OBJECT_EXPORT */
+
+/* 注册表的起止标记 与INIT_EXPORT的rti_start和rti_end一样 */
+RT_USED static const struct rt_object_desc *const __rt_obj_start RT_SECTION(".rt_obj.0") = RT_NULL;
+RT_USED static const struct rt_object_desc *const __rt_obj_end RT_SECTION(".rt_obj.1") = RT_NULL;
+
+/* 注册表中的对象是否有效 未被脱离 也没有被重新初始化到容器中 */
+#define _OBJ_REGISTERED(object, type)   \
+    (((object)->type & ~RT_Object_Class_Static) == (type) && rt_list_isempty(&((object)->list)))
+
+/* 第一个不小于(type, name)的描述符 name为RT_NULL时即该类型的第一个描述符 */
+static const struct rt_object_desc *const *_object_registry_lower(rt_uint8_t type, const char *name)
+{
+    const struct rt_object_desc *const *low, *const *high, *const *mid;
+
+    low  = &__rt_obj_start + 1;
+    high = &__rt_obj_end;
+    while (low < high)
+    {
+        mid = low + (high - low) / 2;
+        if ((*mid)->type < type ||
+            ((*mid)->type == type && name != RT_NULL && rt_strncmp((*mid)->name, name, RT_NAME_MAX) < 0))
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return low;
+}
+
+/* 在注册表中查找对象 已脱离的对象不算 */
+static struct rt_object *_object_registry_find(const char *name, rt_uint8_t type)
+{
+    const struct rt_object_desc *const *desc;
+
+    for (desc = _object_registry_lower(type, name);
+            desc < &__rt_obj_end && (*desc)->type == type &&
+            rt_strncmp((*desc)->name, name, RT_NAME_MAX) == 0;
+            desc ++)
+    {
+        if (_OBJ_REGISTERED((*desc)->object, type))
+            return (*desc)->object;
+    }
+
+    return RT_NULL;
+}
+
+/* 复制注册表中某类对象的指针 最多maxlen个 pointers为RT_NULL时只计数 */
+static int _object_registry_get(rt_uint8_t type, rt_object_t *pointers, int maxlen)
+{
+    int index = 0;
+    const struct rt_object_desc *const *desc;
+
+    for (desc = _object_registry_lower(type, RT_NULL);
+            desc < &__rt_obj_end && (*desc)->type == type;
+            desc ++)
+    {
+        if (!_OBJ_REGISTERED((*desc)->object, type))
+            continue;
+
+        if (pointers != RT_NULL)
+        {
+            if (index >= maxlen)
+                break;
+            pointers[index] = (*desc)->object;
+        }
+        index ++;
+    }
+
+    return index;
+}
+#endif /* RT_USING_OBJECT_REGISTRY */
+
 #ifdef RT_USING_HOOK
 static void (*rt_object_attach_hook)(struct rt_object *object);
 static void (*rt_object_detach_hook)(struct rt_object *object);
@@ -215,6 +637,131 @@ rt_object_get_information(enum rt_object_class_type type)
 }
 RTM_EXPORT(rt_object_get_information);
 
+/**
+ * This function will reset a walker to the first object of the specified type.
+ * The objects in the static object registry are not in the container list and
+ * are not visited by the walker.
+ *
+ * @param walker the walker to be reset.
+ * @param type the type of object, which can be
+ *             RT_Object_Class_Thread/Semaphore/Mutex... etc
+ *
+ * @return RT_EOK on successful, -RT_ERROR if the type is unknown.
+ */
+rt_err_t rt_object_walk_init(struct rt_object_walker *walker, enum rt_object_class_type type)
+{
+    rt_ubase_t level;
+
+    RT_ASSERT(walker != RT_NULL);
+
+    walker->information = rt_object_get_information(type);
+    if (walker->information == RT_NULL)
+        return -RT_ERROR;
+
+    level = rt_hw_interrupt_disable();
+    walker->node    = &(walker->information->object_list);
+    walker->version = _object_list_version[walker->information - rt_object_container];
+    rt_hw_interrupt_enable(level);
+
+    return RT_EOK;
+}
+RTM_EXPORT(rt_object_walk_init);
+
+/**
+ * This function will copy the next objects of a walker. The list is walked in
+ * chunks of RT_OBJECT_WALK_CHUNK objects, interrupts are disabled only during
+ * one chunk, so a long list doesn't delay the interrupts. If an object of the
+ * type is initialized or detached in between, the walker can't go on.
+ *
+ * @param walker the walker, initialized by rt_object_walk_init.
+ * @param pointers the pointers will be saved to, RT_NULL to skip the objects
+ *        and only count them.
+ * @param maxlen the maximum number of objects in this call.
+ *
+ * @return the number of objects, 0 if all objects have been visited, or
+ *         -RT_EBUSY if the list changed since rt_object_walk_init. Then the
+ *         objects got from the walker shall be dropped, and the walker is
+ *         rewound to the first object.
+ */
+int rt_object_walk(struct rt_object_walker *walker, rt_object_t *pointers, int maxlen)
+{
+    int index = 0, chunk;
+    rt_ubase_t level;
+    rt_uint32_t version;
+    struct rt_list_node *head;
+
+    RT_ASSERT(walker != RT_NULL);
+    RT_ASSERT(walker->information != RT_NULL);
+
+    head = &(walker->information->object_list);
+    while (index < maxlen)
+    {
+        level = rt_hw_interrupt_disable();
+
+        /* 版本号未变说明上次停下的节点仍在链表中 可以从它继续 */
+        version = _object_list_version[walker->information - rt_object_container];
+        if (walker->version != version)
+        {
+            walker->node    = head;
+            walker->version = version;
+            rt_hw_interrupt_enable(level);
+            return -RT_EBUSY;
+        }
+
+        for (chunk = 0; chunk < RT_OBJECT_WALK_CHUNK && index < maxlen; chunk ++)
+        {
+            if (walker->node->next == head)
+                break;
+
+            walker->node = walker->node->next;
+            if (pointers != RT_NULL)
+                pointers[index] = rt_list_entry(walker->node, struct rt_object, list);
+            index ++;
+        }
+
+        rt_hw_interrupt_enable(level);
+
+        if (chunk < RT_OBJECT_WALK_CHUNK && index < maxlen)
+            break;
+    }
+
+    return index;
+}
+RTM_EXPORT(rt_object_walk);
+
+/**
+ * This function will get the object a walker stopped at. It shall be called with
+ * interrupts disabled, the object stays in the container until interrupts are
+ * enabled again.
+ *
+ * @param walker the walker, initialized by rt_object_walk_init.
+ *
+ * @return the object, RT_NULL if the walker is at the first object or the list
+ *         changed since the object was visited. Then the walker is rewound.
+ */
+rt_object_t rt_object_walk_current(struct rt_object_walker *walker)
+{
+    rt_uint32_t version;
+    struct rt_list_node *head;
+
+    RT_ASSERT(walker != RT_NULL);
+    RT_ASSERT(walker->information != RT_NULL);
+
+    head    = &(walker->information->object_list);
+    version = _object_list_version[walker->information - rt_object_container];
+    if (walker->version != version)
+    {
+        walker->node    = head;
+        walker->version = version;
+    }
+
+    if (walker->node == head)
+        return RT_NULL;
+
+    return rt_list_entry(walker->node, struct rt_object, list);
+}
+RTM_EXPORT(rt_object_walk_current);
+
 /**
  * This function will return the length of object list in object container.
  *
@@ -225,13 +772,33 @@ RTM_EXPORT(rt_object_get_information);
 /* 获取对象链表长度 */
 int rt_object_get_length(enum rt_object_class_type type)
 {
-    int count = 0;
+    int count = 0, registered = 0, retry, result;
     rt_ubase_t level;
+    struct rt_object_walker walker;
     struct rt_list_node *node = RT_NULL; /* 临时节点 */
     struct rt_object_information *information = RT_NULL;/*  */
     /*  获取对象节点的首地址 */
     information = rt_object_get_information((enum rt_object_class_type)type);
     if (information == RT_NULL) return 0;
+
+#ifdef RT_USING_OBJECT_REGISTRY
+    /* 注册表中的静态对象排在前面 */
+    registered = _object_registry_get(type, RT_NULL, 0);
+#endif /* RT_USING_OBJECT_REGISTRY */
+
+    /* 分段计数 链表在计数过程中变化时重新计数 */
+    for (retry = 0; retry < RT_OBJECT_WALK_RETRY; retry ++)
+    {
+        rt_object_walk_init(&walker, type);
+        count = 0;
+        while ((result = rt_object_walk(&walker, RT_NULL, RT_OBJECT_WALK_CHUNK)) > 0)
+            count += result;
+        if (result == 0)
+            return registered + count;
+    }
+
+    /* 链表一直在变化 退回到关中断一次数完 */
+    count = 0;
     /*  关全局中断 */
     level = rt_hw_interrupt_disable();
     /* get the count of objects */
@@ -243,7 +810,7 @@ int rt_object_get_length(enum rt_object_class_type type)
     }/*  关全局中断 */
     rt_hw_interrupt_enable(level);
     /*  返回对象链表节点的个数 */
-    return count;
+    return registered + count;
 }
 RTM_EXPORT(rt_object_get_length);
 
@@ -261,8 +828,9 @@ RTM_EXPORT(rt_object_get_length);
 /*  */
 int rt_object_get_pointers(enum rt_object_class_type type, rt_object_t *pointers, int maxlen)
 {
-    int index = 0;
+    int index = 0, registered = 0, retry, result = 0;
     rt_ubase_t level;
+    struct rt_object_walker walker;
 
     struct rt_object *object;
     struct rt_list_node *node = RT_NULL;
@@ -272,6 +840,29 @@ int rt_object_get_pointers(enum rt_object_class_type type, rt_object_t *pointers
     /*  获取对象链表节点基地址  */
     information = rt_object_get_information((enum rt_object_class_type)type);
     if (information == RT_NULL) return 0;
+
+#ifdef RT_USING_OBJECT_REGISTRY
+    /* 注册表中的静态对象排在前面 */
+    registered = _object_registry_get(type, pointers, maxlen);
+    pointers += registered;
+    maxlen   -= registered;
+    if (maxlen == 0) return registered;
+#endif /* RT_USING_OBJECT_REGISTRY */
+
+    /* 分段复制 链表在复制过程中变化时重新复制 */
+    for (retry = 0; retry < RT_OBJECT_WALK_RETRY; retry ++)
+    {
+        rt_object_walk_init(&walker, type);
+        index = 0;
+        while (index < maxlen &&
+               (result = rt_object_walk(&walker, &pointers[index], maxlen - index)) > 0)
+            index += result;
+        if (index == maxlen || result == 0)
+            return registered + index;
+    }
+
+    /* 链表一直在变化 退回到关中断一次复制 */
+    index = 0;
     /*  关全局中断 */
     level = rt_hw_interrupt_disable();
     /* retrieve pointer of object */
@@ -288,7 +879,7 @@ int rt_object_get_pointers(enum rt_object_class_type type, rt_object_t *pointers
     }/* 使能全局中断 */
     rt_hw_interrupt_enable(level);
     /*  返回查找到的对象的个数  */
-    return index;
+    return registered + index;
 }
 RTM_EXPORT(rt_object_get_pointers);
 
@@ -339,7 +930,15 @@ void rt_object_init(struct rt_object         *object,
     /* set object type to static */ /* 初始化对象的类型为RT_Object_Class_Static  */
     object->type = type | RT_Object_Class_Static;
     /* copy name *//* 拷贝对象的名字 */
+#ifdef RT_USING_OBJECT_NAME_TABLE
+    object->name_id = _object_name_get(name);
+#else
     rt_strncpy(object->name, name, RT_NAME_MAX);
+#endif /* RT_USING_OBJECT_NAME_TABLE */
+#ifdef RT_USING_OBJECT_REF
+    /* 对象容器持有的引用 */
+    object->ref = 1;
+#endif /* RT_USING_OBJECT_REF */
 
     RT_OBJECT_HOOK_CALL(rt_object_attach_hook, (object));
 
@@ -349,6 +948,13 @@ void rt_object_init(struct rt_object         *object,
     {
         /* insert object into information object list */ /* 将对象通过对象的链表节点挂在对象的容器上 */
         rt_list_insert_after(&(information->object_list), &(object->list));
+        _object_list_version[information - rt_object_container] ++;
+#ifdef RT_USING_OBJECT_HASH
+        _object_hash_insert(object, type);
+#endif /* RT_USING_OBJECT_HASH */
+#ifdef RT_USING_OBJECT_HANDLE
+        _object_handle_alloc(object);
+#endif /* RT_USING_OBJECT_HANDLE */
     }
     /* unlock interrupt *//* 开全局中断 */
     rt_hw_interrupt_enable(temp);
@@ -364,12 +970,16 @@ void rt_object_init(struct rt_object         *object,
 void rt_object_detach(rt_object_t object)
 {
     register rt_base_t temp;
+    rt_uint8_t type;
 
     /* object check */
     RT_ASSERT(object != RT_NULL);
 
     RT_OBJECT_HOOK_CALL(rt_object_detach_hook, (object));
 
+    /* 类型会被清除 先记下对象的类型 */
+    type = object->type & ~RT_Object_Class_Static;
+
     /* reset object type *//* 将对象类型缺省为 0*/
     object->type = 0;
 
@@ -378,11 +988,191 @@ void rt_object_detach(rt_object_t object)
 
     /* remove from old list *//* 将对象的链表节点从对象容器中移除 */
     rt_list_remove(&(object->list));
+    _object_list_changed(type);
+#ifdef RT_USING_OBJECT_HASH
+    _object_hash_remove(object, type);
+#endif /* RT_USING_OBJECT_HASH */
+#ifdef RT_USING_OBJECT_HANDLE
+    _object_handle_free(object);
+#endif /* RT_USING_OBJECT_HANDLE */
+#ifdef RT_USING_OBJECT_NAME_TABLE
+    _object_name_put(object->name_id);
+    object->name_id = 0;
+#endif /* RT_USING_OBJECT_NAME_TABLE */
 
     /* unlock interrupt *//* 开全局中断 */
     rt_hw_interrupt_enable(temp);
 }
 
+/**
+ * This function will take an object off the object container, the name index
+ * and the handle table, keeping its type and memory. It is used by the caches
+ * which keep an object for reuse, the object can't be found any more and shall
+ * be initialized again or released by rt_object_delete later.
+ *
+ * @param object the specified object.
+ */
+void rt_object_unlink(rt_object_t object)
+{
+    register rt_base_t temp;
+
+    RT_ASSERT(object != RT_NULL);
+
+    temp = rt_hw_interrupt_disable();
+    rt_list_remove(&(object->list));
+    _object_list_changed(object->type & ~RT_Object_Class_Static);
+#ifdef RT_USING_OBJECT_HASH
+    _object_hash_remove(object, object->type & ~RT_Object_Class_Static);
+#endif /* RT_USING_OBJECT_HASH */
+#ifdef RT_USING_OBJECT_HANDLE
+    _object_handle_free(object);
+#endif /* RT_USING_OBJECT_HANDLE */
+#ifdef RT_USING_OBJECT_NAME_TABLE
+    _object_name_put(object->name_id);
+    object->name_id = 0;
+#endif /* RT_USING_OBJECT_NAME_TABLE */
+    rt_hw_interrupt_enable(temp);
+}
+RTM_EXPORT(rt_object_unlink);
+
+#ifdef RT_USING_HEAP
+#ifdef RT_USING_OBJECT_SLAB
+#ifndef RT_OBJECT_SLAB_REFILL
+#define RT_OBJECT_SLAB_REFILL   8
+#endif
+
+/*
+ * the free object node, which overlays the beginning of a cached object.
+ */
+/* 缓存中的空闲对象节点 复用对象起始处的空间 */
+struct rt_object_slab_node
+{
+    struct rt_object_slab_node *next;
+};
+
+/*
+ * the slab cache of one object class, which is indexed as rt_object_container.
+ */
+/* 每类内核对象的slab缓存 下标与rt_object_container一致 */
+struct rt_object_slab
+{
+    struct rt_object_slab_node *free_list;      /**< zeroed free objects */ /* 已清零的空闲对象链表 */
+    rt_size_t                   free_count;     /**< number of free objects */ /* 空闲对象个数 */
+    rt_size_t                   total;          /**< number of objects in cache */ /* 缓存中对象总数 */
+};
+
+static struct rt_object_slab _object_slab[RT_Object_Info_Unknown];
+
+/* 从堆中一次性申请多个对象 整块清零后挂入空闲链表 */
+static rt_err_t _object_slab_refill(struct rt_object_information *information,
+                                    struct rt_object_slab *slab)
+{
+    int index;
+    rt_base_t level;
+    rt_size_t size;
+    rt_uint8_t *chunk;
+    struct rt_object_slab_node *node;
+
+    size  = RT_ALIGN(information->object_size, RT_ALIGN_SIZE);
+    chunk = (rt_uint8_t *)RT_KERNEL_MALLOC(size * RT_OBJECT_SLAB_REFILL);
+    if (chunk == RT_NULL)
+    {
+        return -RT_ENOMEM;
+    }
+    /* 构造: 整块清零 之后分配时不再需要rt_memset */
+    rt_memset(chunk, 0x0, size * RT_OBJECT_SLAB_REFILL);
+
+    level = rt_hw_interrupt_disable();
+    for (index = 0; index < RT_OBJECT_SLAB_REFILL; index ++)
+    {
+        node = (struct rt_object_slab_node *)(chunk + index * size);
+        node->next = slab->free_list;
+        slab->free_list = node;
+    }
+    slab->free_count += RT_OBJECT_SLAB_REFILL;
+    slab->total      += RT_OBJECT_SLAB_REFILL;
+    rt_hw_interrupt_enable(level);
+
+    return RT_EOK;
+}
+
+/* 从slab缓存中取出一个已清零的对象 缓存为空时批量补充 */
+static struct rt_object *_object_slab_alloc(struct rt_object_information *information)
+{
+    rt_base_t level;
+    struct rt_object_slab *slab;
+    struct rt_object_slab_node *node;
+
+    slab = &_object_slab[information - rt_object_container];
+
+    while (1)
+    {
+        level = rt_hw_interrupt_disable();
+        node = slab->free_list;
+        if (node != RT_NULL)
+        {
+            slab->free_list = node->next;
+            slab->free_count --;
+            rt_hw_interrupt_enable(level);
+
+            /* 清除链表指针 对象恢复为全零 */
+            node->next = RT_NULL;
+            return (struct rt_object *)node;
+        }
+        rt_hw_interrupt_enable(level);
+
+        if (_object_slab_refill(information, slab) != RT_EOK)
+        {
+            return RT_NULL;
+        }
+    }
+}
+
+/* 将对象清零后放回slab缓存 */
+static void _object_slab_free(struct rt_object_information *information, struct rt_object *object)
+{
+    rt_base_t level;
+    struct rt_object_slab *slab;
+    struct rt_object_slab_node *node;
+
+    slab = &_object_slab[information - rt_object_container];
+
+    rt_memset(object, 0x0, information->object_size);
+    node = (struct rt_object_slab_node *)object;
+
+    level = rt_hw_interrupt_disable();
+    node->next = slab->free_list;
+    slab->free_list = node;
+    slab->free_count ++;
+    rt_hw_interrupt_enable(level);
+}
+
+/**
+ * This function will return the statistics of the slab cache of an object class.
+ *
+ * @param type the type of object
+ * @param total the number of objects held by the cache, may be RT_NULL
+ * @param free_count the number of free objects in the cache, may be RT_NULL
+ *
+ * @return RT_EOK on OK, -RT_ERROR if the type is unknown
+ */
+rt_err_t rt_object_slab_info(enum rt_object_class_type type, rt_size_t *total, rt_size_t *free_count)
+{
+    struct rt_object_information *information;
+    struct rt_object_slab *slab;
+
+    information = rt_object_get_information(type);
+    if (information == RT_NULL) return -RT_ERROR;
+
+    slab = &_object_slab[information - rt_object_container];
+    if (total) *total = slab->total;
+    if (free_count) *free_count = slab->free_count;
+
+    return RT_EOK;
+}
+RTM_EXPORT(rt_object_slab_info);
+#endif /* RT_USING_OBJECT_SLAB */
+
 /**
  * This function will allocate an object from object system
  *
@@ -403,6 +1193,15 @@ rt_object_t rt_object_allocate(enum rt_object_class_type type, const char *name)
     /* get object information */ /* 获取该类对象的基地址 */
     information = rt_object_get_information(type);
     RT_ASSERT(information != RT_NULL);
+#ifdef RT_USING_OBJECT_SLAB
+    /* 从该类对象的slab缓存中取出 取出的对象已经清零 */
+    object = _object_slab_alloc(information);
+    if (object == RT_NULL)
+    {
+        /* no memory can be allocated */ /* 分配失败 */
+        return RT_NULL;
+    }
+#else
     /* 为该对象分配空间 */
     object = (struct rt_object *)RT_KERNEL_MALLOC(information->object_size);
     if (object == RT_NULL)
@@ -413,6 +1212,7 @@ rt_object_t rt_object_allocate(enum rt_object_class_type type, const char *name)
 
     /* clean memory data of object */ /* 初始化刚才为对象分配的空间 */
     rt_memset(object, 0x0, information->object_size);
+#endif /* RT_USING_OBJECT_SLAB */
 
     /* initialize object's parameters */
 
@@ -423,7 +1223,15 @@ rt_object_t rt_object_allocate(enum rt_object_class_type type, const char *name)
     object->flag = 0;
 
     /* copy name */ /* 复制对象名字 */
+#ifdef RT_USING_OBJECT_NAME_TABLE
+    object->name_id = _object_name_get(name);
+#else
     rt_strncpy(object->name, name, RT_NAME_MAX);
+#endif /* RT_USING_OBJECT_NAME_TABLE */
+#ifdef RT_USING_OBJECT_REF
+    /* 对象容器持有的引用 */
+    object->ref = 1;
+#endif /* RT_USING_OBJECT_REF */
 
     RT_OBJECT_HOOK_CALL(rt_object_attach_hook, (object));
 
@@ -433,6 +1241,13 @@ rt_object_t rt_object_allocate(enum rt_object_class_type type, const char *name)
     {
         /* insert object into information object list */ /* 将对象节点插到对象容器中 */
         rt_list_insert_after(&(information->object_list), &(object->list));
+        _object_list_version[information - rt_object_container] ++;
+#ifdef RT_USING_OBJECT_HASH
+        _object_hash_insert(object, type);
+#endif /* RT_USING_OBJECT_HASH */
+#ifdef RT_USING_OBJECT_HANDLE
+        _object_handle_alloc(object);
+#endif /* RT_USING_OBJECT_HANDLE */
     }
 
     /* unlock interrupt *//* 开全局中断 */
@@ -442,14 +1257,220 @@ rt_object_t rt_object_allocate(enum rt_object_class_type type, const char *name)
     return object;
 }
 
+/* 清除对象类型并释放对象的内存 */
+static void _object_destroy(struct rt_object *object)
+{
+#ifdef RT_USING_OBJECT_SLAB
+    struct rt_object_information *information;
+
+    /* 类型会被清除 先记下对象所属的容器 */
+    information = rt_object_get_information((enum rt_object_class_type)object->type);
+    RT_ASSERT(information != RT_NULL);
+#endif /* RT_USING_OBJECT_SLAB */
+
+    /* reset object type */ /* 缺省对象的类型为RT_Object_Class_Null */
+    object->type = RT_Object_Class_Null;
+
+#ifdef RT_USING_OBJECT_SLAB
+    /* 放回slab缓存 */
+    _object_slab_free(information, object);
+#else
+    /* free the memory of object */
+    RT_KERNEL_FREE(object);  /* 释放对象的信息 */
+#endif /* RT_USING_OBJECT_SLAB */
+}
+
+#ifdef RT_USING_OBJECT_REF
+/*
+ * 对象的引用计数
+ *
+ * 动态对象被创建时引用为1 由对象容器持有 rt_object_delete把对象从容器中移除后放掉这个引用
+ * 引用降到0时对象才被释放 在中断中降到0时放入延迟链表 由空闲线程释放
+ * 对象在容器中时引用不为0 在调度器上锁期间查找并加引用 不会与释放竞争
+ * 静态对象的内存不由内核管理 只计数 不释放
+ * 引用计数用比较交换修改 同lfpool.c Cortex-M0等没有独占访问指令的内核用关中断模拟
+ */
+#if defined(__GNUC__) && !defined(ARCH_ARM_CORTEX_M0)
+#define _OBJ_REF_CAS(ptr, expect, desired) \
+    __atomic_compare_exchange_n((ptr), &(expect), (desired), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#define _OBJ_REF_DEC(ptr)   __atomic_sub_fetch((ptr), 1, __ATOMIC_ACQ_REL)
+#else
+#ifdef RT_USING_SMP
+#error "object reference counting needs atomic compare and swap on SMP"
+#endif /* RT_USING_SMP */
+static rt_bool_t _object_ref_cas(volatile rt_uint16_t *ptr, rt_uint16_t *expect, rt_uint16_t desired)
+{
+    rt_base_t level;
+    rt_bool_t result = RT_FALSE;
+
+    level = rt_hw_interrupt_disable();
+    if (*ptr == *expect)
+    {
+        *ptr = desired;
+        result = RT_TRUE;
+    }
+    else
+    {
+        *expect = *ptr;
+    }
+    rt_hw_interrupt_enable(level);
+
+    return result;
+}
+
+static rt_uint16_t _object_ref_dec(volatile rt_uint16_t *ptr)
+{
+    rt_base_t level;
+    rt_uint16_t ref;
+
+    level = rt_hw_interrupt_disable();
+    ref = -- (*ptr);
+    rt_hw_interrupt_enable(level);
+
+    return ref;
+}
+#define _OBJ_REF_CAS(ptr, expect, desired)  _object_ref_cas((ptr), &(expect), (desired))
+#define _OBJ_REF_DEC(ptr)                   _object_ref_dec(ptr)
+#endif /* defined(__GNUC__) && !defined(ARCH_ARM_CORTEX_M0) */
+
+/* 在中断中放掉最后一个引用的对象 通过list链接 */
+static rt_list_t _object_defer_list = RT_LIST_OBJECT_INIT(_object_defer_list);
+
+/**
+ * This function will take a reference of an object, so that its memory isn't
+ * released until rt_object_put. The caller shall already hold a reference,
+ * or get the object in the way of rt_object_find_get.
+ *
+ * @param object the specified object.
+ *
+ * @return RT_EOK on successful, -RT_ERROR if the object is being deleted.
+ */
+rt_err_t rt_object_get(rt_object_t object)
+{
+    rt_uint16_t ref;
+
+    RT_ASSERT(object != RT_NULL);
+
+    ref = object->ref;
+    do
+    {
+        /* 动态对象的引用为0时正在被释放 不能再加引用 */
+        if (ref == 0 && !(object->type & RT_Object_Class_Static))
+            return -RT_ERROR;
+        RT_ASSERT(ref != 0xffff);
+    } while (!_OBJ_REF_CAS(&(object->ref), ref, ref + 1));
+
+    return RT_EOK;
+}
+RTM_EXPORT(rt_object_get);
+
+/**
+ * This function will release a reference of an object. The memory of a
+ * deleted dynamic object is released with the last reference.
+ *
+ * @param object the specified object.
+ */
+void rt_object_put(rt_object_t object)
+{
+    rt_base_t level;
+
+    RT_ASSERT(object != RT_NULL);
+    RT_ASSERT(object->ref != 0);
+
+    if (_OBJ_REF_DEC(&(object->ref)) != 0 || (object->type & RT_Object_Class_Static))
+        return;
+
+    if (rt_interrupt_get_nest() == 0)
+    {
+        _object_destroy(object);
+        return;
+    }
+
+    /* 中断中不能释放内存 交给空闲线程 对象已不在容器中 list可以复用 */
+    level = rt_hw_interrupt_disable();
+    rt_list_insert_before(&_object_defer_list, &(object->list));
+    rt_hw_interrupt_enable(level);
+}
+RTM_EXPORT(rt_object_put);
+
+/**
+ * This function will find an object by name and take a reference of it. The
+ * object can be used without locking the scheduler, and shall be given back
+ * by rt_object_put. The lookup runs with the scheduler locked, the same as
+ * rt_object_find, and the reference is taken with interrupts disabled only if
+ * the object is still in the object system.
+ *
+ * @param name the specified name of object.
+ * @param type the type of object.
+ *
+ * @return the found object or RT_NULL if there is no this object.
+ */
+rt_object_t rt_object_find_get(const char *name, rt_uint8_t type)
+{
+    rt_base_t level;
+    struct rt_object *object;
+
+    /*
+     * 调度器上锁后只有中断能删除对象 中断中删除的对象由空闲线程释放 这期间内存不会被释放
+     * 查找和加引用之间对象可能已被删除或脱离 加引用前在关中断时确认它还在对象系统中
+     */
+    rt_enter_critical();
+    object = rt_object_find(name, type);
+    if (object != RT_NULL)
+    {
+        level = rt_hw_interrupt_disable();
+        /* 脱离的对象类型为0 删除的动态对象已移出容器 静态对象可能在注册表中而不在容器中 */
+        if ((object->type & ~RT_Object_Class_Static) != type ||
+            (!(object->type & RT_Object_Class_Static) && rt_list_isempty(&(object->list))) ||
+            rt_object_get(object) != RT_EOK)
+            object = RT_NULL;
+        rt_hw_interrupt_enable(level);
+    }
+    rt_exit_critical();
+
+    return object;
+}
+RTM_EXPORT(rt_object_find_get);
+
+/**
+ * This function will release the objects whose last reference was released
+ * in interrupt service routines.
+ *
+ * @note this function is invoked by the idle thread.
+ */
+void rt_object_reclaim(void)
+{
+    rt_base_t level;
+    struct rt_object *object;
+
+    while (1)
+    {
+        level = rt_hw_interrupt_disable();
+        if (rt_list_isempty(&_object_defer_list))
+        {
+            rt_hw_interrupt_enable(level);
+            break;
+        }
+        object = rt_list_entry(_object_defer_list.next, struct rt_object, list);
+        rt_list_remove(&(object->list));
+        rt_hw_interrupt_enable(level);
+
+        _object_destroy(object);
+    }
+}
+#endif /* RT_USING_OBJECT_REF */
+
 /**
  * This function will delete an object and release object memory.
+ * With RT_USING_OBJECT_REF, the object is taken off the object system at once,
+ * and its memory is released when the last reference is released.
  *
  * @param object the specified object to be deleted.
  */
 void rt_object_delete(rt_object_t object)
 {
     register rt_base_t temp;
+    rt_uint8_t type;
 
     /* object check */
     RT_ASSERT(object != RT_NULL);
@@ -457,20 +1478,34 @@ void rt_object_delete(rt_object_t object)
 
     RT_OBJECT_HOOK_CALL(rt_object_detach_hook, (object));
 
-    /* reset object type */ /* 缺省对象的类型为RT_Object_Class_Null */
-    object->type = RT_Object_Class_Null;
+    type = object->type;
 
     /* lock interrupt */ /* 关全局中断 */
     temp = rt_hw_interrupt_disable();
 
     /* remove from old list */   /* 从对象容器中移除 */
     rt_list_remove(&(object->list));
+    _object_list_changed(type);
+#ifdef RT_USING_OBJECT_HASH
+    _object_hash_remove(object, type);
+#endif /* RT_USING_OBJECT_HASH */
+#ifdef RT_USING_OBJECT_HANDLE
+    _object_handle_free(object);
+#endif /* RT_USING_OBJECT_HANDLE */
+#ifdef RT_USING_OBJECT_NAME_TABLE
+    _object_name_put(object->name_id);
+    object->name_id = 0;
+#endif /* RT_USING_OBJECT_NAME_TABLE */
 
     /* unlock interrupt */
     rt_hw_interrupt_enable(temp); /* 开全局中断 */
 
-    /* free the memory of object */
-    RT_KERNEL_FREE(object);  /* 释放对象的信息 */
+#ifdef RT_USING_OBJECT_REF
+    /* 放掉对象容器持有的引用 */
+    rt_object_put(object);
+#else
+    _object_destroy(object);
+#endif /* RT_USING_OBJECT_REF */
 }
 #endif /* RT_USING_HEAP */
 
@@ -512,6 +1547,25 @@ rt_uint8_t rt_object_get_type(rt_object_t object)
     return object->type & ~RT_Object_Class_Static;
 }
 
+/**
+ * This function will return the name of object.
+ *
+ * @param object the specified object.
+ *
+ * @return the name of object, which may be not terminated with '\0' if it has
+ *         RT_NAME_MAX characters. With RT_USING_OBJECT_NAME_TABLE, it is valid
+ *         until the object is detached or deleted.
+ */
+/* 获取对象的名字 */
+const char *rt_object_get_name(rt_object_t object)
+{
+    /* object check */
+    RT_ASSERT(object != RT_NULL);
+
+    return _OBJ_NAME(object);
+}
+RTM_EXPORT(rt_object_get_name);
+
 /**
  * This function will find specified name object from object
  * container.
@@ -528,8 +1582,14 @@ rt_uint8_t rt_object_get_type(rt_object_t object)
 rt_object_t rt_object_find(const char *name, rt_uint8_t type)
 {
     struct rt_object *object = RT_NULL;
+#ifndef RT_USING_OBJECT_HASH
     struct rt_list_node *node = RT_NULL;
+#endif /* RT_USING_OBJECT_HASH */
     struct rt_object_information *information = RT_NULL;
+#ifdef RT_USING_OBJECT_NAME_TABLE
+    register rt_base_t temp;
+    rt_uint32_t name_id;
+#endif /* RT_USING_OBJECT_NAME_TABLE */
     /* 获取对象的基地址 */
     information = rt_object_get_information((enum rt_object_class_type)type);
 
@@ -539,6 +1599,39 @@ rt_object_t rt_object_find(const char *name, rt_uint8_t type)
     /* which is invoke in interrupt status */
     RT_DEBUG_NOT_IN_INTERRUPT;
 
+#ifdef RT_USING_OBJECT_REGISTRY
+    /* 先在静态对象注册表中二分查找 */
+    object = _object_registry_find(name, type);
+    if (object != RT_NULL) return object;
+#endif /* RT_USING_OBJECT_REGISTRY */
+
+#ifdef RT_USING_OBJECT_NAME_TABLE
+    /* 名字不在名字表中 就没有叫这个名字的对象 之后先比较name_id */
+    temp = rt_hw_interrupt_disable();
+    name_id = _object_name_lookup(name, RT_NULL);
+    rt_hw_interrupt_enable(temp);
+    if (name_id == 0) return RT_NULL;
+#endif /* RT_USING_OBJECT_NAME_TABLE */
+
+#ifdef RT_USING_OBJECT_HASH
+    rt_enter_critical();
+    /* 只比较同一个桶中的对象 */
+    for (object = _object_hash[_object_hash_index(name, type)]; object != RT_NULL; object = object->hash_next)
+    {
+#ifdef RT_USING_OBJECT_NAME_TABLE
+        if ((object->type & ~RT_Object_Class_Static) == type && _OBJ_NAME_MATCH(object, name, name_id))
+#else
+        if ((object->type & ~RT_Object_Class_Static) == type &&
+            rt_strncmp(object->name, name, RT_NAME_MAX) == 0)
+#endif /* RT_USING_OBJECT_NAME_TABLE */
+        {
+            break;
+        }
+    }
+    rt_exit_critical();
+
+    return object;
+#else
     /* enter critical */
     rt_enter_critical();  /* 调度器上锁 */
 
@@ -546,7 +1639,11 @@ rt_object_t rt_object_find(const char *name, rt_uint8_t type)
     rt_list_for_each(node, &(information->object_list)) /* 遍历该类对象的链表中的对象  */
     {
         object = rt_list_entry(node, struct rt_object, list);/* 获取具体对象的基地址  */
+#ifdef RT_USING_OBJECT_NAME_TABLE
+        if (_OBJ_NAME_MATCH(object, name, name_id))
+#else
         if (rt_strncmp(object->name, name, RT_NAME_MAX) == 0)
+#endif /* RT_USING_OBJECT_NAME_TABLE */
         {
             /* leave critical */
             rt_exit_critical(); /* 调度器解锁 */
@@ -559,6 +1656,120 @@ rt_object_t rt_object_find(const char *name, rt_uint8_t type)
     rt_exit_critical();/* 调度器解锁 */
 
     return RT_NULL;
+#endif /* RT_USING_OBJECT_HASH */
+}
+
+
+#ifdef RT_USING_OBJECT_HANDLE
+/**
+ * This function will return the handle of an object.
+ *
+ * @param object the specified object.
+ *
+ * @return the handle, 0 if the object has no handle because the handle
+ *         table was full when it was initialized.
+ */
+rt_uint32_t rt_object_get_handle(rt_object_t object)
+{
+    RT_ASSERT(object != RT_NULL);
+
+    return object->handle;
+}
+RTM_EXPORT(rt_object_get_handle);
+
+/**
+ * This function will return the object of a handle. A handle of a detached
+ * or deleted object is rejected even if its entry is used again.
+ *
+ * @param handle the handle of the object.
+ * @param type the type of object, RT_Object_Class_Null for any type.
+ *
+ * @return the object, RT_NULL if the handle is invalid or the object is not
+ *         of the type.
+ */
+rt_object_t rt_object_from_handle(rt_uint32_t handle, rt_uint8_t type)
+{
+    register rt_base_t temp;
+    rt_uint32_t index;
+    struct rt_object *object = RT_NULL;
+
+    index = _OBJ_HANDLE_INDEX(handle);
+    if (index >= RT_OBJECT_HANDLE_MAX)
+        return RT_NULL;
+
+    temp = rt_hw_interrupt_disable();
+    if (_object_handle[index].generation == _OBJ_HANDLE_GENERATION(handle))
+    {
+        object = _object_handle[index].object;
+        if (object != RT_NULL && type != RT_Object_Class_Null &&
+            (object->type & ~RT_Object_Class_Static) != type)
+        {
+            object = RT_NULL;
+        }
+    }
+    rt_hw_interrupt_enable(temp);
+
+    return object;
+}
+RTM_EXPORT(rt_object_from_handle);
+
+/**
+ * This function will iterate the objects through the handle table, which is
+ * dense and can be walked without holding the container list. Interrupts are
+ * disabled only while one entry is read.
+ *
+ * @param type the type of object, RT_Object_Class_Null for any type.
+ * @param index the position of iteration, which shall be 0 at the beginning
+ *        and is advanced by every call.
+ *
+ * @return the handle of next object, 0 at the end of the table. The object
+ *         shall be taken by rt_object_from_handle, which fails if it has been
+ *         deleted in between.
+ */
+rt_uint32_t rt_object_handle_next(rt_uint8_t type, rt_uint32_t *index)
+{
+    register rt_base_t temp;
+    rt_uint32_t handle;
+    struct rt_object *object;
+
+    RT_ASSERT(index != RT_NULL);
+
+    while (*index < _object_handle_top)
+    {
+        handle = 0;
+
+        temp = rt_hw_interrupt_disable();
+        object = _object_handle[*index].object;
+        if (object != RT_NULL &&
+            (type == RT_Object_Class_Null || (object->type & ~RT_Object_Class_Static) == type))
+        {
+            handle = object->handle;
+        }
+        rt_hw_interrupt_enable(temp);
+
+        (*index) ++;
+        if (handle != 0)
+            return handle;
+    }
+
+    return 0;
+}
+RTM_EXPORT(rt_object_handle_next);
+#endif /* RT_USING_OBJECT_HANDLE */
+
+#if defined(RT_USING_OBJECT_NAME_TABLE) && defined(RT_USING_FINSH)
+#include <finsh.h>
+
+/* 打印名字表的使用情况 */
+static int list_object_name(void)
+{
+    rt_kprintf("name table: %d/%d used, %d bytes, %d names lost\n",
+               _object_name_used, RT_OBJECT_NAME_TABLE_SIZE - 1,
+               sizeof(_object_name), _object_name_lost);
+
+    return 0;
 }
+MSH_CMD_EXPORT(list_object_name, show object name table usage);
+#endif /* defined(RT_USING_OBJECT_NAME_TABLE) && defined(RT_USING_FINSH) */
 
 /**@}*/
@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2006-2022, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * 区域(region)分配器
+ *
+ * 从一块连续内存中按指针递增的方式分配 对象没有数据头 不能单独释放
+ * 同一生命周期的对象(例如一次请求处理中解析出的对象)由rt_region_reset一次全部释放
+ * 区域本身不加锁 同一时间只应由一个线程使用
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#ifdef RT_USING_REGION
+
+/* 动态创建的区域用完时 从堆上追加的内存块 */
+struct rt_region_chunk
+{
+    struct rt_region_chunk     *next;
+    rt_uint8_t                 *end;
+};
+
+/**
+ * region allocator control block
+ */
+/* 区域控制块 */
+struct rt_region
+{
+    /* 当前的分配位置和结束位置 */
+    rt_uint8_t                 *cur;
+    rt_uint8_t                 *end;
+    /* 第一块内存 reset后从这里重新开始 */
+    rt_uint8_t                 *begin;
+    rt_uint8_t                 *begin_end;
+    /* 追加的内存块 最新的在链表头 */
+    struct rt_region_chunk     *chunks;
+    /* 追加内存块的最小大小 为0时区域不能增长 */
+    rt_size_t                   chunk_size;
+    /* 已分配的字节数和其最大值 */
+    rt_size_t                   used;
+    rt_size_t                   max;
+    /* 区域的内存是否由rt_region_create申请 */
+    rt_uint8_t                  is_dynamic;
+};
+typedef struct rt_region *rt_region_t;
+
+#define REGION_CHUNK_HEAD RT_ALIGN(sizeof(struct rt_region_chunk), RT_ALIGN_SIZE)
+#define REGION_HEAD       RT_ALIGN(sizeof(struct rt_region), RT_ALIGN_SIZE)
+/* 单次申请的上限 对齐或加上数据头后不会溢出 */
+#define REGION_SIZE_MAX   RT_ALIGN_DOWN((rt_size_t)-1 - REGION_HEAD - REGION_CHUNK_HEAD, RT_ALIGN_SIZE)
+
+/**
+ * @brief This function will initialize a region on a memory block.
+ *        The region can't grow, allocation fails once the block is used up.
+ *
+ * @param region the region to be initialized.
+ *
+ * @param begin_addr the beginning address of the memory block.
+ *
+ * @param size the size of the memory block.
+ *
+ * @return the operation status, RT_EOK on successful.
+ */
+rt_err_t rt_region_init(struct rt_region *region, void *begin_addr, rt_size_t size)
+{
+    rt_ubase_t begin, end;
+
+    RT_ASSERT(region != RT_NULL);
+    RT_ASSERT(begin_addr != RT_NULL);
+
+    begin = RT_ALIGN((rt_ubase_t)begin_addr, RT_ALIGN_SIZE);
+    end   = RT_ALIGN_DOWN((rt_ubase_t)begin_addr + size, RT_ALIGN_SIZE);
+    if (end <= begin)
+        return -RT_ERROR;
+
+    rt_memset(region, 0, sizeof(struct rt_region));
+    region->begin     = (rt_uint8_t *)begin;
+    region->begin_end = (rt_uint8_t *)end;
+    region->cur       = region->begin;
+    region->end       = region->begin_end;
+
+    return RT_EOK;
+}
+RTM_EXPORT(rt_region_init);
+
+/**
+ * @brief This function will release all the objects allocated from a region at
+ *        once. The blocks appended from the heap are given back, the first block
+ *        is kept for the next round.
+ *
+ * @param region the region to be reset.
+ */
+void rt_region_reset(rt_region_t region)
+{
+    RT_ASSERT(region != RT_NULL);
+
+#ifdef RT_USING_HEAP
+    {
+        struct rt_region_chunk *chunk;
+
+        while (region->chunks != RT_NULL)
+        {
+            chunk = region->chunks;
+            region->chunks = chunk->next;
+            RT_KERNEL_FREE(chunk);
+        }
+    }
+#endif /* RT_USING_HEAP */
+
+    region->cur  = region->begin;
+    region->end  = region->begin_end;
+    region->used = 0;
+}
+RTM_EXPORT(rt_region_reset);
+
+/**
+ * @brief This function will release all the memory appended to a region.
+ *        The objects allocated from the region must not be used any more.
+ *
+ * @param region the region to be detached.
+ */
+void rt_region_detach(struct rt_region *region)
+{
+    RT_ASSERT(region != RT_NULL);
+
+    rt_region_reset(region);
+    region->begin = region->begin_end = RT_NULL;
+    region->cur   = region->end       = RT_NULL;
+}
+RTM_EXPORT(rt_region_detach);
+
+#ifdef RT_USING_HEAP
+/**
+ * @brief This function will create a region with one heap block of 'size' bytes.
+ *        When the block is used up, the region grows by blocks of at least 'size'
+ *        bytes from the heap.
+ *
+ * @param size the size of the first block, also the minimum size of appended blocks.
+ *
+ * @return the created region, RT_NULL on error.
+ */
+rt_region_t rt_region_create(rt_size_t size)
+{
+    struct rt_region *region;
+
+    RT_DEBUG_NOT_IN_INTERRUPT;
+
+    if (size == 0 || size > REGION_SIZE_MAX)
+        return RT_NULL;
+
+    size = RT_ALIGN(size, RT_ALIGN_SIZE);
+    /* 控制块和第一块内存一次申请 */
+    region = (struct rt_region *)RT_KERNEL_MALLOC(REGION_HEAD + size);
+    if (region == RT_NULL)
+        return RT_NULL;
+
+    if (rt_region_init(region, (rt_uint8_t *)region + REGION_HEAD, size) != RT_EOK)
+    {
+        RT_KERNEL_FREE(region);
+        return RT_NULL;
+    }
+    region->chunk_size = size;
+    region->is_dynamic = 1;
+
+    return region;
+}
+RTM_EXPORT(rt_region_create);
+
+/**
+ * @brief This function will release a region created by rt_region_create and
+ *        all the objects allocated from it.
+ *
+ * @param region the region to be destroyed.
+ */
+void rt_region_destroy(rt_region_t region)
+{
+    RT_DEBUG_NOT_IN_INTERRUPT;
+    RT_ASSERT(region != RT_NULL);
+    RT_ASSERT(region->is_dynamic);
+
+    rt_region_reset(region);
+    RT_KERNEL_FREE(region);
+}
+RTM_EXPORT(rt_region_destroy);
+
+/* 追加一块至少能放下size字节的内存 */
+static rt_err_t _region_grow(struct rt_region *region, rt_size_t size)
+{
+    struct rt_region_chunk *chunk;
+
+    if (size < region->chunk_size)
+        size = region->chunk_size;
+
+    chunk = (struct rt_region_chunk *)RT_KERNEL_MALLOC(REGION_CHUNK_HEAD + size);
+    if (chunk == RT_NULL)
+        return -RT_ENOMEM;
+
+    chunk->end  = (rt_uint8_t *)chunk + REGION_CHUNK_HEAD + size;
+    chunk->next = region->chunks;
+    region->chunks = chunk;
+
+    /* 当前块剩余的部分不再使用 */
+    region->cur = (rt_uint8_t *)chunk + REGION_CHUNK_HEAD;
+    region->end = chunk->end;
+
+    return RT_EOK;
+}
+#endif /* RT_USING_HEAP */
+
+/**
+ * @brief This function will allocate 'size' bytes from a region. The memory
+ *        is released only by rt_region_reset or rt_region_destroy.
+ *
+ * @param region the region.
+ *
+ * @param size the size of memory to be allocated.
+ *
+ * @return the allocated memory, RT_NULL if the region is used up.
+ */
+void *rt_region_alloc(rt_region_t region, rt_size_t size)
+{
+    rt_uint8_t *ptr;
+
+    RT_ASSERT(region != RT_NULL);
+
+    /* 过大的请求对齐时会回绕 */
+    if (size == 0 || size > REGION_SIZE_MAX)
+        return RT_NULL;
+
+    size = RT_ALIGN(size, RT_ALIGN_SIZE);
+    /* 只需移动分配位置 */
+    if ((rt_size_t)(region->end - region->cur) < size)
+    {
+#ifdef RT_USING_HEAP
+        if (region->chunk_size == 0 || _region_grow(region, size) != RT_EOK)
+            return RT_NULL;
+#else
+        return RT_NULL;
+#endif /* RT_USING_HEAP */
+    }
+
+    ptr = region->cur;
+    region->cur += size;
+
+    region->used += size;
+    if (region->used > region->max)
+        region->max = region->used;
+
+    return ptr;
+}
+RTM_EXPORT(rt_region_alloc);
+
+/**
+ * @brief This function will get the memory usage of a region.
+ *
+ * @param region the region.
+ *
+ * @param used the bytes allocated since last reset.
+ *
+ * @param max the maximum of used bytes.
+ */
+void rt_region_info(rt_region_t region, rt_size_t *used, rt_size_t *max)
+{
+    RT_ASSERT(region != RT_NULL);
+
+    if (used)
+        *used = region->used;
+    if (max)
+        *max = region->max;
+}
+RTM_EXPORT(rt_region_info);
+
+#endif /* RT_USING_REGION */
@@ -214,6 +214,10 @@ void rt_schedule(void)
                 rt_schedule_remove_thread(to_thread);
                 /* 将即将运行的线程的状态设置为运行 */
                 to_thread->stat = RT_THREAD_RUNNING | (to_thread->stat & ~RT_THREAD_STAT_MASK);
+#ifdef RT_USING_THREAD_STACK_LAZY_PAINT
+                /* 线程开始运行后 空闲线程不能再为它的栈涂色 */
+                to_thread->stack_paint_open = 0;
+#endif /* RT_USING_THREAD_STACK_LAZY_PAINT */
 
                 /* 切换至新的线程  */
                 RT_DEBUG_LOG(RT_DEBUG_SCHEDULER,
@@ -221,8 +225,8 @@ void rt_schedule(void)
                          "thread:%.*s(sp:0x%08x), "
                          "from thread:%.*s(sp: 0x%08x)\n",
                          rt_interrupt_nest, highest_ready_priority,
-                         RT_NAME_MAX, to_thread->name, to_thread->sp,
-                         RT_NAME_MAX, from_thread->name, from_thread->sp));
+                         RT_NAME_MAX, rt_object_get_name((rt_object_t)to_thread), to_thread->sp,
+                         RT_NAME_MAX, rt_object_get_name((rt_object_t)from_thread), from_thread->sp));
                 /* 未在中断环境中 */
                 if (rt_interrupt_nest == 0)
                 {
@@ -299,7 +303,7 @@ void rt_schedule_insert_thread(struct rt_thread *thread)
     rt_list_insert_before(&(rt_thread_priority_table[thread->current_priority]),&(thread->tlist));
 
     RT_DEBUG_LOG(RT_DEBUG_SCHEDULER, ("insert thread[%.*s], the priority: %d\n",
-                                      RT_NAME_MAX, thread->name, thread->current_priority));
+                                      RT_NAME_MAX, rt_object_get_name((rt_object_t)thread), thread->current_priority));
 
     /* 将查询该优先级的优先级位置为 */
     rt_thread_ready_priority_group |= thread->number_mask;
@@ -326,7 +330,7 @@ void rt_schedule_remove_thread(struct rt_thread *thread)
     level = rt_hw_interrupt_disable();
 
     RT_DEBUG_LOG(RT_DEBUG_SCHEDULER, ("remove thread[%.*s], the priority: %d\n",
-                                      RT_NAME_MAX, thread->name,
+                                      RT_NAME_MAX, rt_object_get_name((rt_object_t)thread),
                                       thread->current_priority));
 
     /* 将线程对象从就绪链表中移除 若该优先级下有同样优先级就绪的任务 则该任务会替补成为该优先级下最先就绪的任务 */
@@ -87,6 +87,11 @@ static void _rt_thread_cleanup_execute(rt_thread_t thread)
     if (thread->cleanup != RT_NULL)
         thread->cleanup(thread);
 
+#ifdef RT_USING_SMALL_MEM_OWNER
+    /* 控制块可能被新线程复用 新线程的分配不能记到这个线程名下 */
+    rt_smem_owner_forget(thread);
+#endif /* RT_USING_SMALL_MEM_OWNER */
+
     rt_hw_interrupt_enable(level);
 }
 
@@ -128,6 +133,37 @@ static void _rt_thread_exit(void)
     rt_hw_interrupt_enable(level);
 }
 
+/*
+ * 延迟涂色: 创建线程时只给栈的最远端涂上RT_THREAD_STACK_PAINT_GUARD个'#' 供溢出检查使用
+ * 其余部分由空闲线程在该线程第一次运行之前分批涂色 线程运行过后未涂色的部分保守地视为已使用
+ * 多核时其他CPU上可能正在运行该线程 仍在创建时一次涂完
+ */
+#if defined(RT_USING_THREAD_STACK_LAZY_PAINT) && !defined(RT_USING_SMP)
+#define THREAD_STACK_LAZY_PAINT
+
+#ifndef RT_THREAD_STACK_PAINT_GUARD
+#define RT_THREAD_STACK_PAINT_GUARD     64
+#endif
+
+/* 距离栈最远端offset字节处 涂色或扫描都从最远端向初始栈帧推进 */
+#ifdef ARCH_CPU_STACK_GROWS_UPWARD
+#define STACK_FAR(thread, offset)   ((rt_uint8_t *)(thread)->stack_addr + (thread)->stack_size - 1 - (offset))
+#else
+#define STACK_FAR(thread, offset)   ((rt_uint8_t *)(thread)->stack_addr + (offset))
+#endif /* ARCH_CPU_STACK_GROWS_UPWARD */
+
+/* 从已涂色部分的边界开始 再涂size个字节 */
+static void _rt_thread_stack_paint(struct rt_thread *thread, rt_uint32_t size)
+{
+#ifdef ARCH_CPU_STACK_GROWS_UPWARD
+    rt_memset(STACK_FAR(thread, thread->stack_painted + size - 1), '#', size);
+#else
+    rt_memset(STACK_FAR(thread, thread->stack_painted), '#', size);
+#endif /* ARCH_CPU_STACK_GROWS_UPWARD */
+    thread->stack_painted += size;
+}
+#endif /* defined(RT_USING_THREAD_STACK_LAZY_PAINT) && !defined(RT_USING_SMP) */
+
 static rt_err_t _rt_thread_init(struct rt_thread *thread,
                                 const char       *name,
                                 void (*entry)(void *parameter),
@@ -148,7 +184,16 @@ static rt_err_t _rt_thread_init(struct rt_thread *thread,
     thread->stack_size = stack_size;
 
     /* init thread stack */
+#ifdef THREAD_STACK_LAZY_PAINT
+    thread->stack_painted = 0;
+    /* 系统启动阶段不在意创建耗时 且此时的线程会先于空闲线程运行 直接涂完 */
+    if (rt_thread_self() == RT_NULL || thread->stack_size <= RT_THREAD_STACK_PAINT_GUARD)
+        _rt_thread_stack_paint(thread, thread->stack_size);
+    else
+        _rt_thread_stack_paint(thread, RT_THREAD_STACK_PAINT_GUARD);
+#else
     rt_memset(thread->stack_addr, '#', thread->stack_size);
+#endif /* THREAD_STACK_LAZY_PAINT */
 #ifdef ARCH_CPU_STACK_GROWS_UPWARD
     thread->sp = (void *)rt_hw_stack_init(thread->entry, thread->parameter,
                                           (void *)((char *)thread->stack_addr),
@@ -158,6 +203,19 @@ static rt_err_t _rt_thread_init(struct rt_thread *thread,
                                           (rt_uint8_t *)((char *)thread->stack_addr + thread->stack_size - sizeof(rt_ubase_t)),
                                           (void *)_rt_thread_exit);
 #endif /* ARCH_CPU_STACK_GROWS_UPWARD */
+#ifdef THREAD_STACK_LAZY_PAINT
+    /* 需要涂色的部分截止到初始栈帧 */
+#ifdef ARCH_CPU_STACK_GROWS_UPWARD
+    thread->stack_paint_target = (rt_uint8_t *)thread->stack_addr + thread->stack_size - (rt_uint8_t *)thread->sp;
+#else
+    thread->stack_paint_target = (rt_uint8_t *)thread->sp - (rt_uint8_t *)thread->stack_addr;
+#endif /* ARCH_CPU_STACK_GROWS_UPWARD */
+    if (thread->stack_painted > thread->stack_paint_target)
+        thread->stack_painted = thread->stack_paint_target;
+    thread->stack_paint_open = 1;
+    thread->stack_scan       = 0;
+    thread->stack_free_min   = thread->stack_paint_target;
+#endif /* THREAD_STACK_LAZY_PAINT */
 
     /* priority init */
     RT_ASSERT(priority < RT_THREAD_PRIORITY_MAX);
@@ -195,7 +253,7 @@ static rt_err_t _rt_thread_init(struct rt_thread *thread,
 
     /* initialize thread timer */
     rt_timer_init(&(thread->thread_timer),
-                  thread->name,
+                  rt_object_get_name((rt_object_t)thread),
                   rt_thread_timeout,
                   thread,
                   0,
@@ -308,7 +366,7 @@ rt_err_t rt_thread_startup(rt_thread_t thread)
     thread->number_mask = 1L << thread->current_priority; /* 设置线程优先级掩码 */
 
     RT_DEBUG_LOG(RT_DEBUG_THREAD, ("startup a thread:%s with priority:%d\n",
-                                   thread->name, thread->init_priority));
+                                   rt_object_get_name((rt_object_t)thread), thread->init_priority));
     /* change thread stat */ /* 初始化线程状态 */
     thread->stat = RT_THREAD_SUSPEND;
     /* then resume it */ /* 启动线程 */
@@ -376,6 +434,116 @@ rt_err_t rt_thread_detach(rt_thread_t thread) /* 线程脱离函数 */
 RTM_EXPORT(rt_thread_detach);
 
 #ifdef RT_USING_HEAP
+#ifdef RT_USING_THREAD_CACHE
+#ifndef RT_THREAD_CACHE_SIZE
+#define RT_THREAD_CACHE_SIZE            4
+#endif
+
+/*
+ * 已退出的动态线程不立即释放 控制块和线程栈一起留在缓存中
+ * rt_thread_create申请相同栈大小的线程时直接取出复用 省去两次申请和释放
+ * 缓存中的线程已从对象容器中移除 通过tlist链接 最新放入的在链表头
+ */
+static rt_list_t _thread_cache = RT_LIST_OBJECT_INIT(_thread_cache);
+static rt_uint16_t _thread_cache_count = 0;
+
+/**
+ * @brief This function will put a defunct dynamic thread into the thread cache,
+ *        keeping its control block and stack for the next rt_thread_create.
+ *
+ * @param thread the defunct thread, whose cleanup has been executed.
+ *
+ * @return RT_EOK if the thread is cached, -RT_EFULL if the cache is full or
+ *         -RT_EBUSY if the thread is still referenced, and the caller shall
+ *         free the thread.
+ *
+ * @note this function is invoked by the idle thread.
+ */
+rt_err_t rt_thread_cache_put(rt_thread_t thread)
+{
+    rt_base_t level;
+
+    RT_ASSERT(thread != RT_NULL);
+    RT_ASSERT(rt_object_is_systemobject((rt_object_t)thread) == RT_FALSE);
+
+    level = rt_hw_interrupt_disable();
+    if (_thread_cache_count >= RT_THREAD_CACHE_SIZE)
+    {
+        rt_hw_interrupt_enable(level);
+        return -RT_EFULL;
+    }
+#ifdef RT_USING_OBJECT_REF
+    /* 还有别人持有引用 控制块不能被复用 */
+    if (thread->ref != 1)
+    {
+        rt_hw_interrupt_enable(level);
+        return -RT_EBUSY;
+    }
+#endif /* RT_USING_OBJECT_REF */
+
+    /* 从对象容器中移除 对象类型保留 以便之后用rt_object_delete释放 */
+    rt_object_unlink((rt_object_t)thread);
+    rt_list_insert_after(&_thread_cache, &(thread->tlist));
+    _thread_cache_count ++;
+    rt_hw_interrupt_enable(level);
+
+    return RT_EOK;
+}
+
+/* 取出栈大小相同的缓存线程 没有则返回RT_NULL */
+static struct rt_thread *_thread_cache_take(rt_uint32_t stack_size)
+{
+    rt_base_t level;
+    rt_list_t *node;
+    struct rt_thread *thread = RT_NULL;
+
+    level = rt_hw_interrupt_disable();
+    for (node = _thread_cache.next; node != &_thread_cache; node = node->next)
+    {
+        if (rt_list_entry(node, struct rt_thread, tlist)->stack_size == stack_size)
+        {
+            thread = rt_list_entry(node, struct rt_thread, tlist);
+            rt_list_remove(node);
+            _thread_cache_count --;
+            break;
+        }
+    }
+    rt_hw_interrupt_enable(level);
+
+    return thread;
+}
+
+/**
+ * @brief This function will release all the threads in the thread cache.
+ */
+void rt_thread_cache_trim(void)
+{
+    rt_base_t level;
+    struct rt_thread *thread;
+
+    RT_DEBUG_NOT_IN_INTERRUPT;
+
+    while (1)
+    {
+        level = rt_hw_interrupt_disable();
+        if (rt_list_isempty(&_thread_cache))
+        {
+            rt_hw_interrupt_enable(level);
+            break;
+        }
+        thread = rt_list_entry(_thread_cache.next, struct rt_thread, tlist);
+        rt_list_remove(&(thread->tlist));
+        _thread_cache_count --;
+        rt_hw_interrupt_enable(level);
+
+        RT_KERNEL_FREE(thread->stack_addr);
+        /* list节点已指向自身 rt_object_delete再次移除不影响容器 */
+        rt_object_delete((rt_object_t)thread);
+    }
+}
+RTM_EXPORT(rt_thread_cache_trim);
+#endif /* RT_USING_THREAD_CACHE */
+
 /**
  * This function will create a thread object and allocate thread object memory
  * and stack.
@@ -399,12 +567,45 @@ rt_thread_t rt_thread_create(const char *name,              /* 线程名称 */
     struct rt_thread *thread;/* 线程句柄 */
     void *stack_start;/* */
 
+#ifdef RT_USING_THREAD_CACHE
+    /* 复用缓存中栈大小相同的线程 */
+    thread = _thread_cache_take(stack_size);
+    if (thread != RT_NULL)
+    {
+        stack_start = thread->stack_addr;
+        /* 与rt_object_allocate一样 从清零的控制块开始 */
+        rt_memset(thread, 0x0, sizeof(struct rt_thread));
+        rt_object_init((rt_object_t)thread, RT_Object_Class_Thread, name);
+        /* 仍是动态对象 */
+        thread->type &= ~RT_Object_Class_Static;
+
+        _rt_thread_init(thread,
+                        name,
+                        entry,
+                        parameter,
+                        stack_start,
+                        stack_size,
+                        priority,
+                        tick);
+
+        return thread;
+    }
+#endif /* RT_USING_THREAD_CACHE */
+
     thread = (struct rt_thread *)rt_object_allocate(RT_Object_Class_Thread,
                                                     name);/* 创建线程对象  */
     if (thread == RT_NULL) /* 创建线程对象失败 */
         return RT_NULL;
 
     stack_start = (void *)RT_KERNEL_MALLOC(stack_size);/* 动态分配内存 */
+#ifdef RT_USING_THREAD_CACHE
+    if (stack_start == RT_NULL)
+    {
+        /* 缓存中其他大小的线程栈占用的内存 释放后再试一次 */
+        rt_thread_cache_trim();
+        stack_start = (void *)RT_KERNEL_MALLOC(stack_size);
+    }
+#endif /* RT_USING_THREAD_CACHE */
     if (stack_start == RT_NULL)/* 内存申请失败 */
     {
         /* allocate stack failure */
@@ -731,7 +932,7 @@ rt_err_t rt_thread_suspend(rt_thread_t thread)/* 挂起线程 */
     RT_ASSERT(thread != RT_NULL);
     RT_ASSERT(rt_object_get_type((rt_object_t)thread) == RT_Object_Class_Thread);/* */
 
-    RT_DEBUG_LOG(RT_DEBUG_THREAD, ("thread suspend:  %s\n", thread->name));
+    RT_DEBUG_LOG(RT_DEBUG_THREAD, ("thread suspend:  %s\n", rt_object_get_name((rt_object_t)thread)));
 
     stat = thread->stat & RT_THREAD_STAT_MASK;/* 获取线程状态 */
     if ((stat != RT_THREAD_READY) && (stat != RT_THREAD_RUNNING))/* */
@@ -779,7 +980,7 @@ rt_err_t rt_thread_resume(rt_thread_t thread)/* 恢复线程 */
     RT_ASSERT(thread != RT_NULL);
     RT_ASSERT(rt_object_get_type((rt_object_t)thread) == RT_Object_Class_Thread);
 
-    RT_DEBUG_LOG(RT_DEBUG_THREAD, ("thread resume:  %s\n", thread->name));
+    RT_DEBUG_LOG(RT_DEBUG_THREAD, ("thread resume:  %s\n", rt_object_get_name((rt_object_t)thread)));
 
     if ((thread->stat & RT_THREAD_STAT_MASK) != RT_THREAD_SUSPEND)
     {
@@ -861,4 +1062,126 @@ rt_thread_t rt_thread_find(char *name)/* 通过名称查找线程对象 */
 }
 RTM_EXPORT(rt_thread_find);
 
+#ifdef RT_USING_OBJECT_HANDLE
+/**
+ * This function will find a thread by its handle.
+ *
+ * @param handle the handle of thread, which is got by rt_object_get_handle
+ *
+ * @return the found thread, RT_NULL if the thread has been deleted
+ */
+rt_thread_t rt_thread_from_handle(rt_uint32_t handle)/* 通过句柄查找线程对象 */
+{
+    return (rt_thread_t)rt_object_from_handle(handle, RT_Object_Class_Thread);
+}
+RTM_EXPORT(rt_thread_from_handle);
+#endif /* RT_USING_OBJECT_HANDLE */
+
+#ifdef THREAD_STACK_LAZY_PAINT
+#ifndef RT_THREAD_STACK_SCAN_BUDGET
+#define RT_THREAD_STACK_SCAN_BUDGET     256
+#endif
+
+/* 正在处理的线程 线程链表变化后游标回到表头 */
+static struct rt_object_walker _stack_scan_walker;
+
+/**
+ * This function will paint or scan the stacks of threads for at most
+ * RT_THREAD_STACK_SCAN_BUDGET bytes. It is invoked by the idle thread, one call
+ * after another the work of painting the stacks of new threads and of finding the
+ * high-water marks is shared across idle periods. The thread being processed is
+ * kept by an object walker, so a call doesn't walk the thread list.
+ *
+ * @return -RT_EBUSY if the round over all threads is not finished,
+ *         -RT_EEMPTY if it is finished or there is no thread.
+ */
+rt_err_t rt_thread_stack_scan_step(void)
+{
+    rt_uint32_t budget, limit;
+    rt_base_t level;
+    rt_err_t result;
+    struct rt_thread *thread;
+
+    if (_stack_scan_walker.information == RT_NULL)
+        rt_object_walk_init(&_stack_scan_walker, RT_Object_Class_Thread);
+
+    /* 关中断期间被处理的线程不会运行 也不会被释放 */
+    level = rt_hw_interrupt_disable();
+
+    thread = (struct rt_thread *)rt_object_walk_current(&_stack_scan_walker);
+    if (thread == RT_NULL)
+    {
+        /* 游标在表头 取第一个线程 没有线程时什么也不做 */
+        if (rt_object_walk(&_stack_scan_walker, RT_NULL, 1) != 1)
+        {
+            rt_hw_interrupt_enable(level);
+            return -RT_EEMPTY;
+        }
+        thread = (struct rt_thread *)rt_object_walk_current(&_stack_scan_walker);
+    }
+
+    /* 已删除线程的栈随时会被释放 */
+    if ((thread->stat & RT_THREAD_STAT_MASK) == RT_THREAD_CLOSE)
+        goto __next;
+
+    /* 还没有运行过的线程 先涂色 */
+    if (thread->stack_paint_open && thread->stack_painted < thread->stack_paint_target)
+    {
+        budget = thread->stack_paint_target - thread->stack_painted;
+        if (budget > RT_THREAD_STACK_SCAN_BUDGET)
+            budget = RT_THREAD_STACK_SCAN_BUDGET;
+        _rt_thread_stack_paint(thread, budget);
+        rt_hw_interrupt_enable(level);
+        return -RT_EBUSY;
+    }
+
+    /* 从最远端开始查找第一个被改写的字节 未涂色的部分视为已使用 */
+    limit  = thread->stack_painted;
+    budget = RT_THREAD_STACK_SCAN_BUDGET;
+    while (budget -- && thread->stack_scan < limit && *STACK_FAR(thread, thread->stack_scan) == '#')
+        thread->stack_scan ++;
+
+    if (thread->stack_scan < limit && *STACK_FAR(thread, thread->stack_scan) == '#')
+    {
+        /* 预算用完 下次继续扫描这个线程 */
+        rt_hw_interrupt_enable(level);
+        return -RT_EBUSY;
+    }
+
+    if (thread->stack_scan < thread->stack_free_min)
+        thread->stack_free_min = thread->stack_scan;
+    thread->stack_scan = 0;
+
+__next:
+    /* 移到下一个线程 一轮结束后回到表头 */
+    result = -RT_EBUSY;
+    if (rt_object_walk(&_stack_scan_walker, RT_NULL, 1) == 0)
+    {
+        rt_object_walk_init(&_stack_scan_walker, RT_Object_Class_Thread);
+        result = -RT_EEMPTY;
+    }
+
+    rt_hw_interrupt_enable(level);
+
+    return result;
+}
+
+/**
+ * This function will get the maximum stack usage of a thread found by the last
+ * scan. The usage of a thread which ran before its stack was fully painted is
+ * over-estimated, never under-estimated.
+ *
+ * @param thread the thread
+ *
+ * @return the maximum number of bytes used in the stack
+ */
+rt_uint32_t rt_thread_stack_max_used(rt_thread_t thread)
+{
+    RT_ASSERT(thread != RT_NULL);
+
+    return thread->stack_size - thread->stack_free_min;
+}
+RTM_EXPORT(rt_thread_stack_max_used);
+#endif /* THREAD_STACK_LAZY_PAINT */
+
 /**@}*/